@@ -93,6 +93,8 @@ inline std::string hipfftResult_string(const hipfftResult_t val)
         return "HIPFFT_NOT_IMPLEMENTED (14)";
     case HIPFFT_NOT_SUPPORTED:
         return "HIPFFT_NOT_SUPPORTED (16)";
+    case HIPFFT_PLAN_NOT_READY:
+        return "HIPFFT_PLAN_NOT_READY (256)";
     default:
         return "invalid hipfftResult";
     }
@@ -157,6 +159,29 @@ public:
 
         workbuffersize = 0;
 
+#ifdef __HIP_PLATFORM_AMD__
+        hipfftExtFootprint footprint;
+        if(hipfftExtEstimateFootprint(nullptr,
+                                      dim(),
+                                      ll_length.data(),
+                                      ll_inembed.data(),
+                                      istride.back(),
+                                      idist,
+                                      inputType,
+                                      ll_onembed.data(),
+                                      ostride.back(),
+                                      odist,
+                                      outputType,
+                                      nbatch,
+                                      execution_type(),
+                                      &footprint)
+           == HIPFFT_SUCCESS)
+        {
+            workbuffersize = footprint.work_buffer_bytes;
+            return val + footprint.total_bytes;
+        }
+#endif
+
         // Hack for estimating buffer requirements.
         workbuffersize = 3 * val;
 
@@ -164,6 +189,22 @@ public:
         return val;
     }
 
+    // execution type is always complex, matching the precision of
+    // the transform
+    hipDataType execution_type() const
+    {
+        switch(precision)
+        {
+        case fft_precision_half:
+            return HIP_C_16F;
+        case fft_precision_single:
+            return HIP_C_32F;
+        case fft_precision_double:
+            return HIP_C_64F;
+        }
+        return HIP_C_64F;
+    }
+
     fft_status setup_structs()
     {
         // set direction
@@ -708,23 +749,6 @@ private:
         if(ret != HIPFFT_SUCCESS)
             return ret;
 
-        // execution type is always complex, matching the precision
-        // of the transform
-        // Initializing as double by default
-        hipDataType executionType = HIP_C_64F;
-        switch(precision)
-        {
-        case fft_precision_half:
-            executionType = HIP_C_16F;
-            break;
-        case fft_precision_single:
-            executionType = HIP_C_32F;
-            break;
-        case fft_precision_double:
-            executionType = HIP_C_64F;
-            break;
-        }
-
         return hipfftXtMakePlanMany(plan,
                                     dim(),
                                     ll_length.data(),
@@ -738,7 +762,7 @@ private:
                                     outputType,
                                     nbatch,
                                     &workbuffersize,
-                                    executionType);
+                                    execution_type());
     }
 };
 
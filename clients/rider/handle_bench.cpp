@@ -0,0 +1,121 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Measures how many plan handles per second can be created and
+// destroyed, from several threads at once.
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "hipfft.h"
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+    // Number of threads creating and destroying handles
+    int nthreads{};
+
+    // Number of handles each thread creates and destroys
+    int niter{};
+
+    // Length of 1D plan to make on each handle, if any
+    int length{};
+
+    // clang-format off
+    po::options_description opdesc("hipfft handle benchmark command line options");
+    opdesc.add_options()("help,h", "produces this help message")
+        ("threads,t", po::value<int>(&nthreads)->default_value(4), "Number of threads")
+        ("iterations,N", po::value<int>(&niter)->default_value(100000),
+         "Handles created and destroyed by each thread")
+        ("length", po::value<int>(&length)->default_value(0),
+         "Length of single-precision 1D C2C plan to make on each handle (0: don't make plans)");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, opdesc), vm);
+    po::notify(vm);
+
+    if(vm.count("help"))
+    {
+        std::cout << opdesc << std::endl;
+        return 0;
+    }
+
+    if(nthreads < 1 || niter < 1 || length < 0)
+    {
+        std::cerr << "threads and iterations must be positive, and length non-negative"
+                  << std::endl;
+        return 1;
+    }
+
+    // create one handle up front so that one-time library setup
+    // isn't measured
+    hipfftHandle warmup{};
+    if(hipfftCreate(&warmup) != HIPFFT_SUCCESS || hipfftDestroy(warmup) != HIPFFT_SUCCESS)
+    {
+        std::cerr << "failed to create handle" << std::endl;
+        return 1;
+    }
+
+    std::atomic<int> failures{0};
+    auto             work = [&]() {
+        for(int i = 0; i < niter; ++i)
+        {
+            hipfftHandle plan{};
+            if(hipfftCreate(&plan) != HIPFFT_SUCCESS)
+            {
+                ++failures;
+                continue;
+            }
+            if(length > 0
+               && hipfftMakePlan1d(plan, length, HIPFFT_C2C, 1, nullptr) != HIPFFT_SUCCESS)
+                ++failures;
+            if(hipfftDestroy(plan) != HIPFFT_SUCCESS)
+                ++failures;
+        }
+    };
+
+    const auto               start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(int t = 0; t < nthreads; ++t)
+        threads.emplace_back(work);
+    for(auto& t : threads)
+        t.join();
+    const double seconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double total = static_cast<double>(nthreads) * niter;
+    std::cout << "threads: " << nthreads << "\n"
+              << "handles: " << static_cast<long long>(total) << "\n"
+              << "seconds: " << seconds << "\n"
+              << "create/destroy per second: " << total / seconds << "\n"
+              << "mean ns per create/destroy: " << seconds * 1e9 / total * nthreads << std::endl;
+
+    if(failures)
+    {
+        std::cerr << failures << " calls failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -20,9 +20,16 @@
 // THE SOFTWARE.
 
 #include "hipfft.h"
+#include "hipfftXt.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <fftw3.h>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <hip/hip_vector_types.h>
+#include <limits>
+#include <thread>
 #include <vector>
 
 #include "../hipfft_params.h"
@@ -630,3 +637,1974 @@ TEST(hipfftTest, OutplaceOnly)
     ASSERT_TRUE(nrmse < type_epsilon<double>());
     fftw_free(ref_out);
 }
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, PlanCacheSharesPlans)
+{
+    ASSERT_EQ(hipfftExtPlanCacheClear(), HIPFFT_SUCCESS);
+
+    hipfftExtPlanCacheStats before;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&before), HIPFFT_SUCCESS);
+    ASSERT_EQ(before.entries, 0);
+
+    // two handles with the same parameters should share plans
+    const size_t n     = 1024;
+    const size_t batch = 3;
+    hipfftHandle plan1 = hipfft_params::INVALID_PLAN_HANDLE;
+    hipfftHandle plan2 = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftPlan1d(&plan1, n, HIPFFT_C2C, batch), HIPFFT_SUCCESS);
+
+    hipfftExtPlanCacheStats after_first;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&after_first), HIPFFT_SUCCESS);
+    EXPECT_GT(after_first.misses, before.misses);
+    EXPECT_GT(after_first.entries, 0);
+
+    ASSERT_EQ(hipfftPlan1d(&plan2, n, HIPFFT_C2C, batch), HIPFFT_SUCCESS);
+
+    hipfftExtPlanCacheStats after_second;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&after_second), HIPFFT_SUCCESS);
+    EXPECT_EQ(after_second.misses, after_first.misses);
+    EXPECT_EQ(after_second.hits - after_first.hits, after_first.entries);
+    EXPECT_EQ(after_second.entries, after_first.entries);
+
+    // plans are still usable after being evicted from the cache
+    ASSERT_EQ(hipfftExtPlanCacheSetCapacity(0), HIPFFT_SUCCESS);
+    hipfftExtPlanCacheStats evicted;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&evicted), HIPFFT_SUCCESS);
+    EXPECT_EQ(evicted.entries, 0);
+    EXPECT_EQ(evicted.evictions - after_second.evictions, after_second.entries);
+
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, n * batch * sizeof(hipfftComplex)), hipSuccess);
+    EXPECT_EQ(hipfftExecC2C(plan2, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+
+    ASSERT_EQ(hipfftDestroy(plan1), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan2), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanCacheSetCapacity(before.capacity), HIPFFT_SUCCESS);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, LazyPlanCreation)
+{
+    ASSERT_EQ(hipfftExtPlanCacheClear(), HIPFFT_SUCCESS);
+
+    const int    n     = 1000;
+    const int    batch = 5;
+    hipfftHandle plan  = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanLazy(plan, 1), HIPFFT_SUCCESS);
+
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+
+    // nothing should be created until execution
+    hipfftExtPlanCacheStats stats;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.entries, 0);
+
+    hipfftComplex* d_in  = nullptr;
+    hipfftComplex* d_out = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, n * batch * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, n * batch * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemset(d_in, 0, n * batch * sizeof(hipfftComplex)), hipSuccess);
+
+    // only the out-of-place forward plan is needed
+    EXPECT_EQ(hipfftExecC2C(plan, d_in, d_out, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.entries, 1);
+
+    // executing again reuses the same plan
+    EXPECT_EQ(hipfftExecC2C(plan, d_in, d_out, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.entries, 1);
+
+    EXPECT_EQ(hipfftExecC2C(plan, d_out, d_out, HIPFFT_BACKWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.entries, 2);
+
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, PlanHints)
+{
+    ASSERT_EQ(hipfftExtPlanCacheClear(), HIPFFT_SUCCESS);
+
+    // odd length R2C needs a work buffer
+    int          n    = 2047;
+    int          nc   = n / 2 + 1;
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+
+    EXPECT_EQ(hipfftExtPlanHints(plan, 0, HIPFFT_EXT_DIRECTION_FORWARD), HIPFFT_INVALID_VALUE);
+    EXPECT_EQ(hipfftExtPlanHints(plan, HIPFFT_EXT_PLACEMENT_NOTINPLACE, 0x4), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(
+        hipfftExtPlanHints(plan, HIPFFT_EXT_PLACEMENT_NOTINPLACE, HIPFFT_EXT_DIRECTION_FORWARD),
+        HIPFFT_SUCCESS);
+
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlanMany(
+                  plan, 1, &n, nullptr, 1, n, nullptr, 1, nc, HIPFFT_R2C, 1, &workSize),
+              HIPFFT_SUCCESS);
+
+    // only the out-of-place forward plan was created
+    hipfftExtPlanCacheStats stats;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.entries, 1);
+
+    hipfftReal*    d_in  = nullptr;
+    hipfftComplex* d_out = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, nc * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, nc * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemset(d_in, 0, nc * sizeof(hipfftComplex)), hipSuccess);
+
+    EXPECT_EQ(hipfftExecR2C(plan, d_in, d_out), HIPFFT_SUCCESS);
+    // in-place was not hinted
+    EXPECT_NE(hipfftExecR2C(plan, reinterpret_cast<hipfftReal*>(d_out), d_out), HIPFFT_SUCCESS);
+
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+
+    // hints that exclude every sub-plan of the transform type are invalid
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanHints(plan, HIPFFT_EXT_PLACEMENT_ALL, HIPFFT_EXT_DIRECTION_BACKWARD),
+              HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_R2C, 1, &workSize), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, GetSizeLeavesPlanCache)
+{
+    ASSERT_EQ(hipfftExtPlanCacheClear(), HIPFFT_SUCCESS);
+
+    int n  = 2047;
+    int nc = n / 2 + 1;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(
+        hipfftExtPlanHints(plan, HIPFFT_EXT_PLACEMENT_NOTINPLACE, HIPFFT_EXT_DIRECTION_FORWARD),
+        HIPFFT_SUCCESS);
+
+    // size query honours the handle's hints
+    size_t estimate = 0;
+    ASSERT_EQ(
+        hipfftGetSizeMany(plan, 1, &n, nullptr, 1, n, nullptr, 1, nc, HIPFFT_R2C, 1, &estimate),
+        HIPFFT_SUCCESS);
+
+    // size queries don't fill the cache, even when repeated
+    size_t again = 0;
+    ASSERT_EQ(
+        hipfftGetSizeMany(plan, 1, &n, nullptr, 1, n, nullptr, 1, nc, HIPFFT_R2C, 1, &again),
+        HIPFFT_SUCCESS);
+    EXPECT_EQ(again, estimate);
+
+    hipfftExtPlanCacheStats before;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&before), HIPFFT_SUCCESS);
+    EXPECT_EQ(before.entries, 0);
+
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlanMany(
+                  plan, 1, &n, nullptr, 1, n, nullptr, 1, nc, HIPFFT_R2C, 1, &workSize),
+              HIPFFT_SUCCESS);
+    EXPECT_EQ(workSize, estimate);
+
+    hipfftExtPlanCacheStats after;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&after), HIPFFT_SUCCESS);
+    EXPECT_EQ(after.entries, 1);
+
+    // nor do queries of out-of-core plans, which need no work area
+    hipfftHandle ooc = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&ooc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanOutOfCore(ooc, 1), HIPFFT_SUCCESS);
+    size_t ooc_size = 1;
+    ASSERT_EQ(hipfftGetSize1d(ooc, 1 << 20, HIPFFT_C2C, 1, &ooc_size), HIPFFT_SUCCESS);
+    EXPECT_EQ(ooc_size, 0);
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&after), HIPFFT_SUCCESS);
+    EXPECT_EQ(after.entries, 1);
+    ASSERT_EQ(hipfftDestroy(ooc), HIPFFT_SUCCESS);
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, AsyncPlanCreation)
+{
+    ASSERT_EQ(hipfftExtPlanCacheClear(), HIPFFT_SUCCESS);
+
+    long long int n     = 1031;
+    long long int batch = 3;
+
+    hipfftHandle plan       = hipfft_params::INVALID_PLAN_HANDLE;
+    auto         make_async = [&](hipDataType itype, hipDataType otype) {
+        return hipfftExtMakePlanManyAsync(
+            plan, 1, &n, nullptr, 1, n, itype, nullptr, 1, n, otype, batch, HIP_C_32F);
+    };
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+
+    // bad parameters are reported straight away
+    EXPECT_EQ(make_async(HIP_R_32F, HIP_R_32F), HIPFFT_INVALID_VALUE);
+
+    ASSERT_EQ(make_async(HIP_C_32F, HIP_C_32F), HIPFFT_SUCCESS);
+
+    // poll until the plan is ready
+    hipfftResult query = HIPFFT_PLAN_NOT_READY;
+    while(query == HIPFFT_PLAN_NOT_READY)
+        query = hipfftExtPlanQuery(plan);
+    ASSERT_EQ(query, HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtPlanWait(plan), HIPFFT_SUCCESS);
+
+    // a synchronously-created plan with the same parameters finds
+    // the background plan's work in the cache
+    hipfftExtPlanCacheStats before;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&before), HIPFFT_SUCCESS);
+
+    hipfftHandle sync_plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&sync_plan), HIPFFT_SUCCESS);
+    size_t sync_workSize = 0;
+    ASSERT_EQ(hipfftXtMakePlanMany(sync_plan,
+                                   1,
+                                   &n,
+                                   nullptr,
+                                   1,
+                                   n,
+                                   HIP_C_32F,
+                                   nullptr,
+                                   1,
+                                   n,
+                                   HIP_C_32F,
+                                   batch,
+                                   &sync_workSize,
+                                   HIP_C_32F),
+              HIPFFT_SUCCESS);
+
+    hipfftExtPlanCacheStats after;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&after), HIPFFT_SUCCESS);
+    EXPECT_EQ(after.misses, before.misses);
+
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftGetSize(plan, &workSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(workSize, sync_workSize);
+
+    // executing right after an async plan call waits for it
+    ASSERT_EQ(make_async(HIP_C_32F, HIP_C_32F), HIPFFT_SUCCESS);
+
+    size_t         bytes = n * batch * sizeof(hipfftComplex);
+    hipfftComplex* d_in  = nullptr;
+    hipfftComplex* d_out = nullptr;
+    ASSERT_EQ(hipMalloc(&d_in, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_out, bytes), hipSuccess);
+    ASSERT_EQ(hipMemset(d_in, 0, bytes), hipSuccess);
+
+    EXPECT_EQ(hipfftXtExec(plan, d_in, d_out, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftXtExec(plan, d_in, d_in, HIPFFT_BACKWARD), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtPlanQuery(plan), HIPFFT_SUCCESS);
+
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(sync_plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_in), hipSuccess);
+    ASSERT_EQ(hipFree(d_out), hipSuccess);
+
+    // destroying a plan that is still being created is fine
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(make_async(HIP_C_32F, HIP_C_32F), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, ConcurrentSubplanCreation)
+{
+    int    n        = 1031;
+    int    batch    = 5;
+    size_t workSize = 0;
+
+    std::vector<hipfftExtPlanBuildMetrics> metrics(2);
+    std::vector<size_t>                    workSizes(2);
+    for(int concurrent : {0, 1})
+    {
+        // start from a cold cache so every backend plan is built
+        ASSERT_EQ(hipfftExtPlanCacheClear(), HIPFFT_SUCCESS);
+
+        hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExtPlanConcurrentBuild(plan, concurrent), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+        workSizes[concurrent] = workSize;
+        ASSERT_EQ(hipfftExtPlanGetBuildMetrics(plan, &metrics[concurrent]), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    }
+    EXPECT_EQ(workSizes[0], workSizes[1]);
+
+    for(const auto& m : metrics)
+    {
+        // each of the four sub-plans was built and timed
+        for(double seconds : {m.inplace_forward_seconds,
+                              m.outofplace_forward_seconds,
+                              m.inplace_backward_seconds,
+                              m.outofplace_backward_seconds})
+        {
+            EXPECT_GT(seconds, 0.0);
+            EXPECT_GE(m.total_seconds, seconds);
+        }
+    }
+
+    // building one after another takes at least as long as all of
+    // the sub-plans combined
+    const auto& sequential = metrics[0];
+    EXPECT_GE(sequential.total_seconds,
+              sequential.inplace_forward_seconds + sequential.outofplace_forward_seconds
+                  + sequential.inplace_backward_seconds + sequential.outofplace_backward_seconds);
+
+    // hints and lazy creation leave sub-plans unbuilt
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanConcurrentBuild(plan, 1), HIPFFT_SUCCESS);
+    ASSERT_EQ(
+        hipfftExtPlanHints(plan, HIPFFT_EXT_PLACEMENT_NOTINPLACE, HIPFFT_EXT_DIRECTION_FORWARD),
+        HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+    hipfftExtPlanBuildMetrics hinted;
+    ASSERT_EQ(hipfftExtPlanGetBuildMetrics(plan, &hinted), HIPFFT_SUCCESS);
+    EXPECT_EQ(hinted.inplace_forward_seconds, 0.0);
+    EXPECT_EQ(hinted.inplace_backward_seconds, 0.0);
+    EXPECT_EQ(hinted.outofplace_backward_seconds, 0.0);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, WisdomRoundTrip)
+{
+    const char* path = "hipfft_test_wisdom.bin";
+
+    int    n        = 1543;
+    size_t workSize = 0;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, 1, &workSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    ASSERT_EQ(hipfftExtExportWisdom(path), HIPFFT_SUCCESS);
+
+    // importing remembers the plans without filling the cache, and
+    // size queries find them
+    ASSERT_EQ(hipfftExtPlanCacheClear(), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtImportWisdom(path), HIPFFT_SUCCESS);
+
+    size_t queried_workSize = 0;
+    ASSERT_EQ(hipfftEstimate1d(n, HIPFFT_C2C, 1, &queried_workSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(queried_workSize, workSize);
+
+    hipfftExtPlanCacheStats stats;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.entries, 0);
+
+    size_t imported_workSize = 0;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, 1, &imported_workSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(imported_workSize, workSize);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    // corrupt files are rejected
+    std::string wisdom;
+    {
+        std::ifstream in(path, std::ios::binary);
+        wisdom.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    ASSERT_GT(wisdom.size(), 0);
+    wisdom[wisdom.size() / 2] ^= 0x1;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(wisdom.data(), wisdom.size());
+    }
+    EXPECT_EQ(hipfftExtImportWisdom(path), HIPFFT_PARSE_ERROR);
+
+    ASSERT_EQ(std::remove(path), 0);
+    EXPECT_EQ(hipfftExtImportWisdom(path), HIPFFT_INVALID_VALUE);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, PlanClone)
+{
+    const int num_streams = 4;
+
+    int    n        = 2048;
+    int    batch    = 3;
+    size_t workSize = 0;
+    size_t bytes    = n * batch * sizeof(hipfftComplex);
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+
+    hipfftExtPlanCacheStats before;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&before), HIPFFT_SUCCESS);
+
+    std::vector<hipfftHandle>   clones(num_streams, hipfft_params::INVALID_PLAN_HANDLE);
+    std::vector<hipStream_t>    streams(num_streams, nullptr);
+    std::vector<hipfftComplex*> buffers(num_streams, nullptr);
+    for(int i = 0; i < num_streams; ++i)
+    {
+        ASSERT_EQ(hipfftExtPlanClone(plan, &clones[i]), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipStreamCreate(&streams[i]), hipSuccess);
+        ASSERT_EQ(hipfftSetStream(clones[i], streams[i]), HIPFFT_SUCCESS);
+
+        size_t cloneWorkSize = 0;
+        ASSERT_EQ(hipfftGetSize(clones[i], &cloneWorkSize), HIPFFT_SUCCESS);
+        EXPECT_EQ(cloneWorkSize, workSize);
+
+        ASSERT_EQ(hipMalloc(&buffers[i], bytes), hipSuccess);
+        ASSERT_EQ(hipMemset(buffers[i], 0, bytes), hipSuccess);
+    }
+
+    // cloning didn't need any new plans
+    hipfftExtPlanCacheStats after;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&after), HIPFFT_SUCCESS);
+    EXPECT_EQ(after.hits, before.hits);
+    EXPECT_EQ(after.misses, before.misses);
+
+    EXPECT_EQ(hipfftExtPlanClone(plan, nullptr), HIPFFT_INVALID_VALUE);
+
+    // clones outlive the original plan
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    for(int i = 0; i < num_streams; ++i)
+        EXPECT_EQ(hipfftExecC2C(clones[i], buffers[i], buffers[i], HIPFFT_FORWARD), HIPFFT_SUCCESS);
+
+    for(int i = 0; i < num_streams; ++i)
+    {
+        ASSERT_EQ(hipStreamSynchronize(streams[i]), hipSuccess);
+        ASSERT_EQ(hipfftDestroy(clones[i]), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipStreamDestroy(streams[i]), hipSuccess);
+        ASSERT_EQ(hipFree(buffers[i]), hipSuccess);
+    }
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, SetBatch)
+{
+    int n = 1031;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+
+    // the plan has to be initialized first
+    EXPECT_EQ(hipfftExtSetBatch(plan, 2), HIPFFT_INVALID_PLAN);
+
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, 1, &workSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtSetBatch(plan, -1), HIPFFT_INVALID_SIZE);
+    EXPECT_EQ(hipfftExtSetBatch(plan, 0), HIPFFT_INVALID_SIZE);
+
+    std::vector<hipfftComplex> host(n * 16);
+    for(size_t i = 0; i < host.size(); ++i)
+    {
+        host[i].x = (i % n) == 0 ? 1.0f : 0.0f;
+        host[i].y = 0.0f;
+    }
+
+    size_t         bytes  = host.size() * sizeof(hipfftComplex);
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, bytes), hipSuccess);
+
+    for(int batch : {16, 3, 16})
+    {
+        ASSERT_EQ(hipfftExtSetBatch(plan, batch), HIPFFT_SUCCESS);
+
+        // work area size matches a plan made from scratch
+        size_t batchWorkSize = 0;
+        ASSERT_EQ(hipfftGetSize(plan, &batchWorkSize), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftEstimate1d(n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+        EXPECT_EQ(batchWorkSize, workSize);
+
+        // every transform in the batch is performed: the FFT of an
+        // impulse is all ones
+        ASSERT_EQ(hipMemcpy(d_data, host.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+        ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+        std::vector<hipfftComplex> out(host.size());
+        ASSERT_EQ(hipMemcpy(out.data(), d_data, bytes, hipMemcpyDeviceToHost), hipSuccess);
+        for(int i = 0; i < n * batch; ++i)
+        {
+            EXPECT_NEAR(out[i].x, 1.0f, 1e-4);
+            EXPECT_NEAR(out[i].y, 0.0f, 1e-4);
+        }
+        // data beyond the batch is untouched
+        for(size_t i = n * batch; i < out.size(); ++i)
+            EXPECT_EQ(out[i].x, host[i].x);
+    }
+
+    // returning to a batch count planned before finds it in the cache
+    hipfftExtPlanCacheStats before;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&before), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetBatch(plan, 3), HIPFFT_SUCCESS);
+    hipfftExtPlanCacheStats after;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&after), HIPFFT_SUCCESS);
+    EXPECT_EQ(after.misses, before.misses);
+
+    // a failed change leaves the plan as it was
+    size_t previousWorkSize = 0;
+    ASSERT_EQ(hipfftGetSize(plan, &previousWorkSize), HIPFFT_SUCCESS);
+    ASSERT_GT(previousWorkSize, 0);
+    ASSERT_EQ(hipfftExtSetMemoryLimit(plan, 1), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtSetBatch(plan, 8), HIPFFT_ALLOC_FAILED);
+    ASSERT_EQ(hipfftExtSetMemoryLimit(plan, 0), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftGetSize(plan, &workSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(workSize, previousWorkSize);
+
+    ASSERT_EQ(hipMemcpy(d_data, host.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    std::vector<hipfftComplex> out(host.size());
+    ASSERT_EQ(hipMemcpy(out.data(), d_data, bytes, hipMemcpyDeviceToHost), hipSuccess);
+    for(size_t i = 0; i < out.size(); ++i)
+        EXPECT_NEAR(out[i].x, i < static_cast<size_t>(n) * 3 ? 1.0f : host[i].x, 1e-4);
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, EstimateFootprint)
+{
+    ASSERT_EQ(hipfftExtPlanCacheClear(), HIPFFT_SUCCESS);
+
+    // a length not planned anywhere else, so the work area size
+    // starts out as an estimate
+    long long int n     = 100003;
+    long long int batch = 2;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanHints(plan, HIPFFT_EXT_PLACEMENT_NOTINPLACE, HIPFFT_EXT_DIRECTION_ALL),
+              HIPFFT_SUCCESS);
+
+    hipfftExtFootprint estimate;
+    ASSERT_EQ(hipfftExtEstimateFootprint(plan,
+                                         1,
+                                         &n,
+                                         nullptr,
+                                         1,
+                                         n,
+                                         HIP_C_32F,
+                                         nullptr,
+                                         1,
+                                         n,
+                                         HIP_C_32F,
+                                         batch,
+                                         HIP_C_32F,
+                                         &estimate),
+              HIPFFT_SUCCESS);
+    EXPECT_EQ(estimate.num_sub_plans, 2);
+    EXPECT_EQ(estimate.work_buffer_exact, 0);
+    EXPECT_GT(estimate.work_buffer_bytes, 0);
+    EXPECT_GT(estimate.twiddle_bytes, 0);
+    EXPECT_EQ(estimate.total_bytes,
+              estimate.work_buffer_bytes + estimate.twiddle_bytes + estimate.sub_plan_bytes
+                  + estimate.callback_bytes);
+
+    // estimating created no plans
+    hipfftExtPlanCacheStats stats;
+    ASSERT_EQ(hipfftExtPlanCacheGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.entries, 0);
+
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftXtMakePlanMany(plan,
+                                   1,
+                                   &n,
+                                   nullptr,
+                                   1,
+                                   n,
+                                   HIP_C_32F,
+                                   nullptr,
+                                   1,
+                                   n,
+                                   HIP_C_32F,
+                                   batch,
+                                   &workSize,
+                                   HIP_C_32F),
+              HIPFFT_SUCCESS);
+
+    // once the plan exists, the work area size is exact
+    hipfftExtFootprint exact;
+    ASSERT_EQ(hipfftExtEstimateFootprint(plan,
+                                         1,
+                                         &n,
+                                         nullptr,
+                                         1,
+                                         n,
+                                         HIP_C_32F,
+                                         nullptr,
+                                         1,
+                                         n,
+                                         HIP_C_32F,
+                                         batch,
+                                         HIP_C_32F,
+                                         &exact),
+              HIPFFT_SUCCESS);
+    EXPECT_EQ(exact.work_buffer_exact, 1);
+    EXPECT_EQ(exact.work_buffer_bytes, workSize);
+    EXPECT_EQ(exact.twiddle_bytes, estimate.twiddle_bytes);
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, WorkBufferPool)
+{
+    ASSERT_EQ(hipfftExtWorkBufferPoolTrim(), HIPFFT_SUCCESS);
+    hipfftExtWorkBufferPoolStats before;
+    ASSERT_EQ(hipfftExtWorkBufferPoolGetStats(&before), HIPFFT_SUCCESS);
+    EXPECT_EQ(before.bytes_allocated, 0);
+
+    // lengths large enough to need a work area
+    const std::vector<int> lengths = {1 << 20, (1 << 20) - (1 << 16)};
+    const int              batch   = 2;
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+
+    std::vector<hipfftHandle> plans;
+    size_t                    maxWorkSize = 0;
+    for(int n : lengths)
+    {
+        hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExtPlanWorkBufferMode(plan, HIPFFT_EXT_WORKBUFFER_POOL), HIPFFT_SUCCESS);
+        size_t workSize = 0;
+        ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+        ASSERT_GT(workSize, 0);
+        ASSERT_EQ(hipfftSetStream(plan, stream), HIPFFT_SUCCESS);
+        maxWorkSize = std::max(maxWorkSize, workSize);
+        plans.push_back(plan);
+    }
+
+    // initializing pooled plans allocates nothing
+    hipfftExtWorkBufferPoolStats stats;
+    ASSERT_EQ(hipfftExtWorkBufferPoolGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.allocations, before.allocations);
+
+    size_t         bytes  = static_cast<size_t>(lengths[0]) * batch * sizeof(hipfftComplex);
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, bytes), hipSuccess);
+    ASSERT_EQ(hipMemset(d_data, 0, bytes), hipSuccess);
+
+    for(int iter = 0; iter < 3; ++iter)
+        for(auto plan : plans)
+            ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+    // plans running back to back on one stream share a buffer, so
+    // the pool only ever needs enough for the biggest one
+    ASSERT_EQ(hipfftExtWorkBufferPoolGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.bytes_in_use, 0);
+    EXPECT_GE(stats.high_water_bytes, maxWorkSize);
+    EXPECT_LT(stats.high_water_bytes, 2 * maxWorkSize * 2);
+    EXPECT_GT(stats.reuses, before.reuses);
+
+    ASSERT_EQ(hipfftExtWorkBufferPoolTrim(), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtWorkBufferPoolGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.bytes_allocated, 0);
+
+    // switching back to eager allocation gives the plan its own buffer
+    ASSERT_EQ(hipfftExtPlanWorkBufferMode(plans[0], HIPFFT_EXT_WORKBUFFER_EAGER), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plans[0], d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+    ASSERT_EQ(hipfftExtWorkBufferPoolGetStats(&stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.bytes_allocated, 0);
+
+    for(auto plan : plans)
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, WorkAreaGroup)
+{
+    // lengths large enough to need a work area
+    const std::vector<int> lengths = {1 << 20, (1 << 20) - (1 << 16)};
+    const int              batch   = 2;
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+
+    hipfftExtWorkAreaGroup group = nullptr;
+    ASSERT_EQ(hipfftExtWorkAreaGroupCreate(&group), HIPFFT_SUCCESS);
+
+    std::vector<hipfftHandle> plans;
+    std::vector<size_t>       workSizes;
+    for(int n : lengths)
+    {
+        hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+        size_t workSize = 0;
+        ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+        ASSERT_GT(workSize, 0);
+        ASSERT_EQ(hipfftSetStream(plan, stream), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExtWorkAreaGroupAddPlan(group, plan), HIPFFT_SUCCESS);
+        plans.push_back(plan);
+        workSizes.push_back(workSize);
+    }
+
+    // the group holds one buffer, sized for its largest plan
+    const size_t maxWorkSize = *std::max_element(workSizes.begin(), workSizes.end());
+    size_t       groupSize   = 0;
+    ASSERT_EQ(hipfftExtWorkAreaGroupGetSize(group, &groupSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(groupSize, maxWorkSize);
+
+    // a plan can only be in one group
+    hipfftExtWorkAreaGroup other = nullptr;
+    ASSERT_EQ(hipfftExtWorkAreaGroupCreate(&other), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtWorkAreaGroupAddPlan(other, plans[0]), HIPFFT_INVALID_VALUE);
+
+    // and not if the caller provides its work area
+    hipfftHandle manual = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&manual), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftSetAutoAllocation(manual, 0), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(manual, lengths[0], HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftExtWorkAreaGroupAddPlan(other, manual), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftDestroy(manual), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtWorkAreaGroupDestroy(other), HIPFFT_SUCCESS);
+
+    size_t         bytes  = static_cast<size_t>(lengths[0]) * batch * sizeof(hipfftComplex);
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, bytes), hipSuccess);
+    ASSERT_EQ(hipMemset(d_data, 0, bytes), hipSuccess);
+
+    for(auto plan : plans)
+        ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+    // growing a member grows the group's buffer
+    ASSERT_EQ(hipfftExtSetBatch(plans[1], 2 * batch), HIPFFT_SUCCESS);
+    size_t grownWorkSize = 0;
+    ASSERT_EQ(hipfftGetSize(plans[1], &grownWorkSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtWorkAreaGroupGetSize(group, &groupSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(groupSize, std::max(maxWorkSize, grownWorkSize));
+    ASSERT_EQ(hipfftExecC2C(plans[1], d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+    // removing the largest plan shrinks the buffer to what is left
+    ASSERT_EQ(hipfftExtWorkAreaGroupRemovePlan(group, plans[1]), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtWorkAreaGroupGetSize(group, &groupSize), HIPFFT_SUCCESS);
+    EXPECT_EQ(groupSize, workSizes[0]);
+    ASSERT_EQ(hipfftExecC2C(plans[1], d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+    // members get their own work areas back when the group goes away
+    ASSERT_EQ(hipfftExtWorkAreaGroupDestroy(group), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plans[0], d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+    for(auto plan : plans)
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, DeferredWorkBuffer)
+{
+    // length large enough to need a work area
+    const int n     = 1 << 20;
+    const int batch = 2;
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+
+    size_t         bytes  = static_cast<size_t>(n) * batch * sizeof(hipfftComplex);
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, bytes), hipSuccess);
+    ASSERT_EQ(hipMemset(d_data, 0, bytes), hipSuccess);
+
+    for(auto mode : {HIPFFT_EXT_WORKBUFFER_DEFERRED, HIPFFT_EXT_WORKBUFFER_DEFERRED_ASYNC})
+    {
+        hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExtPlanWorkBufferMode(plan, mode), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftSetStream(plan, stream), HIPFFT_SUCCESS);
+
+        // initializing the plan leaves the work area unallocated
+        size_t freeBefore = 0, freeAfter = 0, total = 0;
+        ASSERT_EQ(hipMemGetInfo(&freeBefore, &total), hipSuccess);
+        size_t workSize = 0;
+        ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+        ASSERT_GT(workSize, 0);
+        ASSERT_EQ(hipMemGetInfo(&freeAfter, &total), hipSuccess);
+        EXPECT_LT(freeBefore - std::min(freeBefore, freeAfter), workSize);
+
+        // executing allocates it, and trimming frees it until the
+        // next execution
+        for(int iter = 0; iter < 2; ++iter)
+        {
+            ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+            ASSERT_EQ(hipfftExtPlanTrimWorkBuffer(plan), HIPFFT_SUCCESS);
+        }
+        ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    }
+
+    // trimmed eager plans reallocate on next execution too
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanTrimWorkBuffer(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, DeferredAsyncStreamChange)
+{
+    // length large enough to need a work area
+    const int    n        = 1 << 20;
+    const size_t elements = n;
+    const size_t bytes    = elements * sizeof(hipfftComplex);
+
+    std::vector<hipfftComplex> input(elements);
+    for(size_t i = 0; i < elements; ++i)
+        input[i] = {static_cast<float>(i % 5), static_cast<float>(i % 11)};
+    hipfftComplex* d_input  = nullptr;
+    hipfftComplex* d_output = nullptr;
+    ASSERT_EQ(hipMalloc(&d_input, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_output, bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_input, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+
+    hipfftHandle reference = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&reference), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(reference, n, HIPFFT_C2C, 1, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(reference, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    std::vector<hipfftComplex> expected(elements), output(elements);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    hipStream_t streams[3] = {};
+    for(auto& stream : streams)
+        ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanWorkBufferMode(plan, HIPFFT_EXT_WORKBUFFER_DEFERRED_ASYNC),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftSetStream(plan, streams[0]), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, 1, nullptr), HIPFFT_SUCCESS);
+
+    auto check = [&](hipStream_t stream) {
+        ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+        ASSERT_EQ(hipMemcpy(output.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+        for(size_t i = 0; i < elements; ++i)
+        {
+            ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+            ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+        }
+        ASSERT_EQ(hipMemset(d_output, 0, bytes), hipSuccess);
+    };
+
+    // the work buffer is allocated on the first stream, then used
+    // from another one after the plan's stream changes, and from a
+    // group's stream
+    ASSERT_EQ(hipfftExecC2C(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    check(streams[0]);
+    for(int iter = 0; iter < 2; ++iter)
+    {
+        ASSERT_EQ(hipfftExecC2C(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftSetStream(plan, streams[1]), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExecC2C(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+        check(streams[1]);
+
+        void*     in[1]         = {d_input};
+        void*     out[1]        = {d_output};
+        const int directions[1] = {HIPFFT_FORWARD};
+        ASSERT_EQ(hipfftExtExecGroup(1, &plan, in, out, directions, streams[2]), HIPFFT_SUCCESS);
+        check(streams[2]);
+        ASSERT_EQ(hipfftSetStream(plan, streams[0]), HIPFFT_SUCCESS);
+    }
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(reference), HIPFFT_SUCCESS);
+    for(auto stream : streams)
+        ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_output), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, MemoryLimitSplitsBatch)
+{
+    // length large enough to need a work area, and a batch that
+    // doesn't split evenly
+    const int n     = 1 << 20;
+    const int batch = 5;
+
+    hipfftHandle full = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&full), HIPFFT_SUCCESS);
+    size_t fullWorkSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(full, n, HIPFFT_C2C, batch, &fullWorkSize), HIPFFT_SUCCESS);
+    ASSERT_GT(fullWorkSize, 0);
+
+    hipfftHandle limited = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&limited), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetMemoryLimit(limited, fullWorkSize / 2), HIPFFT_SUCCESS);
+    size_t limitedWorkSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(limited, n, HIPFFT_C2C, batch, &limitedWorkSize), HIPFFT_SUCCESS);
+    EXPECT_LE(limitedWorkSize, fullWorkSize / 2);
+
+    std::vector<hipfftComplex> input(static_cast<size_t>(n) * batch);
+    for(size_t i = 0; i < input.size(); ++i)
+        input[i] = {static_cast<float>(i % 7), static_cast<float>(i % 3)};
+    const size_t   bytes    = input.size() * sizeof(hipfftComplex);
+    hipfftComplex* d_input  = nullptr;
+    hipfftComplex* d_output = nullptr;
+    ASSERT_EQ(hipMalloc(&d_input, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_output, bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_input, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+
+    // the split batch gives the same results as the whole one
+    std::vector<hipfftComplex> expected(input.size()), actual(input.size());
+    ASSERT_EQ(hipfftExecC2C(full, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+    ASSERT_EQ(hipMemset(d_output, 0, bytes), hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(limited, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(actual.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+    for(size_t i = 0; i < actual.size(); ++i)
+    {
+        ASSERT_NEAR(actual[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+        ASSERT_NEAR(actual[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+    }
+
+    // a limit too small for even one transform fails
+    hipfftHandle tiny = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&tiny), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetMemoryLimit(tiny, 1), HIPFFT_SUCCESS);
+    EXPECT_EQ(hipfftMakePlan1d(tiny, n, HIPFFT_C2C, batch, nullptr), HIPFFT_ALLOC_FAILED);
+
+    ASSERT_EQ(hipfftDestroy(tiny), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(limited), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(full), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_output), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, RecycledHandles)
+{
+    // small enough to need no work area, so the execution info gets
+    // recycled
+    const int n = 64;
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, n * sizeof(hipfftComplex)), hipSuccess);
+    ASSERT_EQ(hipMemset(d_data, 0, n * sizeof(hipfftComplex)), hipSuccess);
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, 1, &workSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(workSize, size_t(0));
+    ASSERT_EQ(hipfftSetStream(plan, stream), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+
+    // a handle reusing the old one's state must not inherit its
+    // stream, which no longer exists
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, 1, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+
+    // handles can be created and destroyed from several threads at once
+    std::vector<std::thread> threads;
+    std::atomic<int>         failures{0};
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&]() {
+            std::vector<hipfftHandle> plans(100);
+            for(auto& p : plans)
+                if(hipfftCreate(&p) != HIPFFT_SUCCESS)
+                    ++failures;
+            for(auto p : plans)
+                if(hipfftDestroy(p) != HIPFFT_SUCCESS)
+                    ++failures;
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    EXPECT_EQ(failures, 0);
+
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, PrefetchManaged)
+{
+    const int    n     = 1 << 16;
+    const int    batch = 3;
+    const size_t bytes = static_cast<size_t>(n) * batch * sizeof(hipfftComplex);
+
+    hipfftComplex* m_data = nullptr;
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMallocManaged(&m_data, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_data, bytes), hipSuccess);
+    ASSERT_EQ(hipMemset(d_data, 0, bytes), hipSuccess);
+    ASSERT_EQ(hipMemset(m_data, 0, bytes), hipSuccess);
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+
+    // nothing is prefetched unless asked for
+    hipfftExtPrefetchStats stats;
+    ASSERT_EQ(hipfftExecC2C(plan, m_data, m_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanGetPrefetchStats(plan, &stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.bytes_prefetched, 0);
+    EXPECT_EQ(stats.prefetches, 0);
+
+    // managed buffers are prefetched, device buffers aren't
+    ASSERT_EQ(hipfftExtPlanPrefetchManaged(plan, 1), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plan, m_data, m_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plan, m_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    ASSERT_EQ(hipfftExtPlanGetPrefetchStats(plan, &stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.bytes_prefetched, 2 * bytes);
+    EXPECT_EQ(stats.prefetches, 2);
+
+    // as are those of executions split across streams
+    hipStream_t streams[2] = {};
+    for(auto& stream : streams)
+        ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+    ASSERT_EQ(hipfftExtSetStreams(plan, 2, streams), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExecC2C(plan, m_data, m_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    ASSERT_EQ(hipfftExtPlanGetPrefetchStats(plan, &stats), HIPFFT_SUCCESS);
+    EXPECT_EQ(stats.bytes_prefetched, 3 * bytes);
+    EXPECT_EQ(stats.prefetches, 3);
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    for(auto stream : streams)
+        ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(m_data), hipSuccess);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+#endif
+
+#ifdef __HIP_PLATFORM_AMD__
+TEST(hipfftTest, HostStaging)
+{
+    const int    n        = 1 << 12;
+    const int    batch    = 7;
+    const size_t elements = static_cast<size_t>(n) * batch;
+    const size_t bytes    = elements * sizeof(hipfftComplex);
+
+    hipfftComplex* h_input  = nullptr;
+    hipfftComplex* h_output = nullptr;
+    ASSERT_EQ(hipHostMalloc(&h_input, bytes, hipHostMallocDefault), hipSuccess);
+    ASSERT_EQ(hipHostMalloc(&h_output, bytes, hipHostMallocDefault), hipSuccess);
+    for(size_t i = 0; i < elements; ++i)
+        h_input[i] = {static_cast<float>(i % 5), static_cast<float>(i % 11)};
+
+    // reference result, computed on device memory
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+    hipfftComplex* d_input  = nullptr;
+    hipfftComplex* d_output = nullptr;
+    ASSERT_EQ(hipMalloc(&d_input, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_output, bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_input, h_input, bytes, hipMemcpyHostToDevice), hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    std::vector<hipfftComplex> expected(elements);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+    ASSERT_EQ(hipfftSetStream(plan, stream), HIPFFT_SUCCESS);
+
+    // chunks that don't divide the batch evenly, out-of-place and
+    // in-place
+    ASSERT_EQ(hipfftExtPlanHostStaging(plan, 3, 2), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExec(plan, h_input, h_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+    for(size_t i = 0; i < elements; ++i)
+    {
+        ASSERT_NEAR(h_output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+        ASSERT_NEAR(h_output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+    }
+
+    ASSERT_EQ(hipfftXtExec(plan, h_input, h_input, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+    for(size_t i = 0; i < elements; ++i)
+    {
+        ASSERT_NEAR(h_input[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+        ASSERT_NEAR(h_input[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+    }
+
+    // device pointers still execute directly
+    ASSERT_EQ(hipfftXtExec(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_output), hipSuccess);
+    ASSERT_EQ(hipHostFree(h_input), hipSuccess);
+    ASSERT_EQ(hipHostFree(h_output), hipSuccess);
+}
+
+// Transform host data with an out-of-core plan, and compare with an
+// in-core plan on device memory
+template <typename Complex>
+static void check_out_of_core(std::vector<int> n, int batch, hipfftType type, size_t limit)
+{
+    const int rank     = static_cast<int>(n.size());
+    size_t    elements = batch;
+    for(auto len : n)
+        elements *= len;
+    const size_t bytes = elements * sizeof(Complex);
+
+    std::vector<Complex> input(elements);
+    for(size_t i = 0; i < elements; ++i)
+        input[i] = {static_cast<decltype(input[i].x)>(i % 5),
+                    static_cast<decltype(input[i].y)>(i % 11)};
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlanMany(
+                  plan, rank, n.data(), nullptr, 1, 0, nullptr, 1, 0, type, batch, nullptr),
+              HIPFFT_SUCCESS);
+    Complex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, bytes), hipSuccess);
+
+    hipfftHandle ooc_plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&ooc_plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanOutOfCore(ooc_plan, 1), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetMemoryLimit(ooc_plan, limit), HIPFFT_SUCCESS);
+    size_t workSize = 1;
+    ASSERT_EQ(hipfftMakePlanMany(
+                  ooc_plan, rank, n.data(), nullptr, 1, 0, nullptr, 1, 0, type, batch, &workSize),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(workSize, size_t(0));
+
+    for(auto direction : {HIPFFT_FORWARD, HIPFFT_BACKWARD})
+    {
+        std::vector<Complex> expected(elements);
+        ASSERT_EQ(hipMemcpy(d_data, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+        ASSERT_EQ(hipfftXtExec(plan, d_data, d_data, direction), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipMemcpy(expected.data(), d_data, bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+        // out-of-place, then in-place
+        std::vector<Complex> output(elements);
+        ASSERT_EQ(hipfftXtExec(ooc_plan, input.data(), output.data(), direction),
+                  HIPFFT_SUCCESS);
+        std::vector<Complex> inplace = input;
+        ASSERT_EQ(hipfftXtExec(ooc_plan, inplace.data(), inplace.data(), direction),
+                  HIPFFT_SUCCESS);
+        for(size_t i = 0; i < elements; ++i)
+        {
+            const double tol_x = 1e-5 * std::abs(expected[i].x) + 1e-2;
+            const double tol_y = 1e-5 * std::abs(expected[i].y) + 1e-2;
+            ASSERT_NEAR(output[i].x, expected[i].x, tol_x);
+            ASSERT_NEAR(output[i].y, expected[i].y, tol_y);
+            ASSERT_NEAR(inplace[i].x, expected[i].x, tol_x);
+            ASSERT_NEAR(inplace[i].y, expected[i].y, tol_y);
+        }
+    }
+
+    // device memory isn't accepted
+    ASSERT_EQ(hipfftXtExec(ooc_plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_INVALID_VALUE);
+    std::vector<Complex> output(elements);
+    ASSERT_EQ(hipfftXtExec(ooc_plan, input.data(), d_data, HIPFFT_FORWARD), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftXtExec(ooc_plan, d_data, output.data(), HIPFFT_FORWARD), HIPFFT_INVALID_VALUE);
+
+    ASSERT_EQ(hipfftDestroy(ooc_plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+
+TEST(hipfftTest, OutOfCore)
+{
+    // four-step 1D, with a last chunk smaller than the others
+    check_out_of_core<hipfftComplex>({3 * 5 * 7 * 64}, 2, HIPFFT_C2C, 64 << 10);
+    // slabs then pencils
+    check_out_of_core<hipfftDoubleComplex>({64, 32, 48}, 1, HIPFFT_Z2Z, 1 << 20);
+
+    // real transforms and prime 1D lengths aren't supported
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanOutOfCore(plan, 1), HIPFFT_SUCCESS);
+    int n = 4096;
+    ASSERT_EQ(hipfftMakePlanMany(plan, 1, &n, nullptr, 1, 0, nullptr, 1, 0, HIPFFT_R2C, 1, nullptr),
+              HIPFFT_NOT_IMPLEMENTED);
+    n = 4099;
+    ASSERT_EQ(hipfftMakePlanMany(plan, 1, &n, nullptr, 1, 0, nullptr, 1, 0, HIPFFT_C2C, 1, nullptr),
+              HIPFFT_INVALID_SIZE);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+
+TEST(hipfftTest, PinnedPool)
+{
+    const int    n        = 1 << 12;
+    const int    batch    = 6;
+    const size_t elements = static_cast<size_t>(n) * batch;
+    const size_t bytes    = elements * sizeof(hipfftComplex);
+
+    std::vector<hipfftComplex> input(elements);
+    for(size_t i = 0; i < elements; ++i)
+        input[i] = {static_cast<float>(i % 5), static_cast<float>(i % 11)};
+
+    // reference result, computed on device memory
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_data, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    std::vector<hipfftComplex> expected(elements);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_data, bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    // pageable input and output are copied through the pool
+    ASSERT_EQ(hipfftExtPlanHostStaging(plan, 2, 1), HIPFFT_SUCCESS);
+    auto check = [&](hipfftExtPinnedPoolStats& stats) {
+        std::vector<hipfftComplex> output(elements);
+        ASSERT_EQ(hipfftXtExec(plan, input.data(), output.data(), HIPFFT_FORWARD),
+                  HIPFFT_SUCCESS);
+        for(size_t i = 0; i < elements; ++i)
+        {
+            ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+            ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+        }
+        ASSERT_EQ(hipfftExtPinnedPoolGetStats(&stats), HIPFFT_SUCCESS);
+    };
+
+    hipfftExtPinnedPoolStats before, first, second, limited;
+    ASSERT_EQ(hipfftExtPinnedPoolGetStats(&before), HIPFFT_SUCCESS);
+    check(first);
+    EXPECT_GT(first.bytes_allocated, size_t(0));
+    EXPECT_LE(first.bytes_allocated, first.bytes_limit);
+    EXPECT_EQ(first.bytes_in_use, size_t(0));
+    EXPECT_EQ(first.fallbacks, before.fallbacks);
+
+    // a second execution reuses the buffers
+    check(second);
+    EXPECT_EQ(second.allocations, first.allocations);
+    EXPECT_GT(second.reuses, first.reuses);
+
+    // without room in the pool, copies go directly
+    ASSERT_EQ(hipfftExtPinnedPoolSetLimit(0), HIPFFT_SUCCESS);
+    check(limited);
+    EXPECT_EQ(limited.bytes_allocated, size_t(0));
+    EXPECT_GT(limited.fallbacks, second.fallbacks);
+
+    ASSERT_EQ(hipfftExtPinnedPoolSetLimit(before.bytes_limit), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPinnedPoolTrim(), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+
+TEST(hipfftTest, StagingMemoryKinds)
+{
+    const int    n        = 1 << 12;
+    const size_t elements = n;
+    const size_t bytes    = elements * sizeof(hipfftComplex);
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, 1, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanHostStaging(plan, 1, 1), HIPFFT_SUCCESS);
+
+    // a std::vector is pageable, so it's copied through the pinned pool
+    std::vector<hipfftComplex> input(elements, hipfftComplex{1.0f, 0.0f});
+    std::vector<hipfftComplex> output(elements);
+    hipfftExtPinnedPoolStats   before, pageable, pinned;
+    ASSERT_EQ(hipfftExtPinnedPoolGetStats(&before), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExec(plan, input.data(), output.data(), HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPinnedPoolGetStats(&pageable), HIPFFT_SUCCESS);
+    EXPECT_GT(pageable.allocations + pageable.reuses + pageable.fallbacks,
+              before.allocations + before.reuses + before.fallbacks);
+    EXPECT_NEAR(output[0].x, n, 1e-5 * n + 1e-2);
+
+    // pinned memory is copied directly
+    hipfftComplex* h_data = nullptr;
+    ASSERT_EQ(hipHostMalloc(&h_data, bytes, hipHostMallocDefault), hipSuccess);
+    std::copy(input.begin(), input.end(), h_data);
+    ASSERT_EQ(hipfftXtExec(plan, h_data, h_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPinnedPoolGetStats(&pinned), HIPFFT_SUCCESS);
+    EXPECT_EQ(pinned.allocations, pageable.allocations);
+    EXPECT_EQ(pinned.reuses, pageable.reuses);
+    EXPECT_EQ(pinned.fallbacks, pageable.fallbacks);
+    EXPECT_NEAR(h_data[0].x, n, 1e-5 * n + 1e-2);
+
+    ASSERT_EQ(hipHostFree(h_data), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+}
+
+TEST(hipfftTest, TrimMemory)
+{
+    const int    n     = 1 << 22;
+    const size_t bytes = n * sizeof(hipfftComplex);
+
+    hipfftHandle plan     = hipfft_params::INVALID_PLAN_HANDLE;
+    size_t       workSize = 0;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, 1, &workSize), HIPFFT_SUCCESS);
+    if(workSize == 0)
+    {
+        ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+        GTEST_SKIP() << "transform needs no work area";
+    }
+
+    std::vector<hipfftComplex> input(n);
+    for(int i = 0; i < n; ++i)
+        input[i] = {static_cast<float>(i % 5), static_cast<float>(i % 11)};
+    hipfftComplex* d_data = nullptr;
+    ASSERT_EQ(hipMalloc(&d_data, bytes), hipSuccess);
+    std::vector<hipfftComplex> expected(n), output(n);
+    ASSERT_EQ(hipMemcpy(d_data, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_data, bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    // the trimmed plan gets a new work area when it's next executed
+    ASSERT_EQ(hipfftExtTrimMemory(), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(d_data, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+    ASSERT_EQ(hipfftExecC2C(plan, d_data, d_data, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(output.data(), d_data, bytes, hipMemcpyDeviceToHost), hipSuccess);
+    for(int i = 0; i < n; ++i)
+    {
+        ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+        ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+    }
+
+    // fill the device so that another plan's work area only fits
+    // once the idle plan's work area is freed
+    size_t free = 0, total = 0;
+    void*  hog  = nullptr;
+    ASSERT_EQ(hipMemGetInfo(&free, &total), hipSuccess);
+    if(free > workSize && hipMalloc(&hog, free - workSize / 2) == hipSuccess)
+    {
+        hipfftHandle other = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&other), HIPFFT_SUCCESS);
+        EXPECT_EQ(hipfftMakePlan1d(other, n, HIPFFT_C2C, 1, nullptr), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftDestroy(other), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipFree(hog), hipSuccess);
+    }
+
+    // with nothing idle left to free, have the callback make room
+    struct pressure_state
+    {
+        void* hog   = nullptr;
+        int   calls = 0;
+    } state;
+    auto callback = [](size_t, void* user_data) {
+        auto state = static_cast<pressure_state*>(user_data);
+        ++state->calls;
+        if(!state->hog || hipfftExtTrimMemory() != HIPFFT_SUCCESS)
+            return 0;
+        (void)hipFree(state->hog);
+        state->hog = nullptr;
+        return 1;
+    };
+    ASSERT_EQ(hipfftExtTrimMemory(), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemGetInfo(&free, &total), hipSuccess);
+    if(free > workSize && hipMalloc(&state.hog, free - workSize / 2) == hipSuccess)
+    {
+        ASSERT_EQ(hipfftExtSetMemoryPressureCallback(callback, &state), HIPFFT_SUCCESS);
+        hipfftHandle other = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&other), HIPFFT_SUCCESS);
+        EXPECT_EQ(hipfftMakePlan1d(other, n, HIPFFT_C2C, 1, nullptr), HIPFFT_SUCCESS);
+        EXPECT_GE(state.calls, 1);
+        EXPECT_EQ(state.hog, nullptr);
+        ASSERT_EQ(hipfftExtSetMemoryPressureCallback(nullptr, nullptr), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftDestroy(other), HIPFFT_SUCCESS);
+        if(state.hog)
+        {
+            ASSERT_EQ(hipFree(state.hog), hipSuccess);
+        }
+    }
+
+    // a callback that keeps asking for another try without freeing
+    // anything is given up on
+    auto stubborn = [](size_t, void* user_data) {
+        ++*static_cast<int*>(user_data);
+        return 1;
+    };
+    int stubborn_calls = 0;
+    ASSERT_EQ(hipfftExtTrimMemory(), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemGetInfo(&free, &total), hipSuccess);
+    if(free > workSize && hipMalloc(&hog, free - workSize / 2) == hipSuccess)
+    {
+        ASSERT_EQ(hipfftExtSetMemoryPressureCallback(stubborn, &stubborn_calls),
+                  HIPFFT_SUCCESS);
+        hipfftHandle other = hipfft_params::INVALID_PLAN_HANDLE;
+        ASSERT_EQ(hipfftCreate(&other), HIPFFT_SUCCESS);
+        EXPECT_EQ(hipfftMakePlan1d(other, n, HIPFFT_C2C, 1, nullptr), HIPFFT_ALLOC_FAILED);
+        EXPECT_EQ(stubborn_calls, 8);
+        ASSERT_EQ(hipfftExtSetMemoryPressureCallback(nullptr, nullptr), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftDestroy(other), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipFree(hog), hipSuccess);
+    }
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_data), hipSuccess);
+}
+
+TEST(hipfftTest, ExecGroup)
+{
+    // differently shaped plans, in each work area mode
+    const int                           count   = 3;
+    const std::vector<std::vector<int>> lengths = {{1 << 16}, {96, 80}, {3000}};
+    const std::vector<int>              batches = {2, 1, 3};
+    const hipfftExtWorkBufferMode       modes[count]
+        = {HIPFFT_EXT_WORKBUFFER_POOL, HIPFFT_EXT_WORKBUFFER_DEFERRED, HIPFFT_EXT_WORKBUFFER_EAGER};
+    const int directions[count] = {HIPFFT_FORWARD, HIPFFT_BACKWARD, HIPFFT_FORWARD};
+
+    hipfftHandle                            plans[count];
+    void*                                   idata[count];
+    void*                                   odata[count];
+    std::vector<size_t>                     bytes(count);
+    std::vector<std::vector<hipfftComplex>> expected(count);
+    for(int i = 0; i < count; ++i)
+    {
+        size_t elements = batches[i];
+        for(auto len : lengths[i])
+            elements *= len;
+        bytes[i] = elements * sizeof(hipfftComplex);
+
+        std::vector<int> n = lengths[i];
+        ASSERT_EQ(hipfftCreate(&plans[i]), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftExtPlanWorkBufferMode(plans[i], modes[i]), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipfftMakePlanMany(plans[i],
+                                     static_cast<int>(n.size()),
+                                     n.data(),
+                                     nullptr,
+                                     1,
+                                     0,
+                                     nullptr,
+                                     1,
+                                     0,
+                                     HIPFFT_C2C,
+                                     batches[i],
+                                     nullptr),
+                  HIPFFT_SUCCESS);
+
+        std::vector<hipfftComplex> input(elements);
+        for(size_t j = 0; j < elements; ++j)
+            input[j] = {static_cast<float>((i + j) % 5), static_cast<float>(j % 11)};
+        ASSERT_EQ(hipMalloc(&idata[i], bytes[i]), hipSuccess);
+        ASSERT_EQ(hipMalloc(&odata[i], bytes[i]), hipSuccess);
+        ASSERT_EQ(hipMemcpy(idata[i], input.data(), bytes[i], hipMemcpyHostToDevice), hipSuccess);
+
+        // reference result from executing the plan on its own
+        expected[i].resize(elements);
+        ASSERT_EQ(hipfftXtExec(plans[i], idata[i], odata[i], directions[i]), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipMemcpy(expected[i].data(), odata[i], bytes[i], hipMemcpyDeviceToHost),
+                  hipSuccess);
+        ASSERT_EQ(hipMemset(odata[i], 0, bytes[i]), hipSuccess);
+    }
+
+    // deferred work areas are freed, so the group lends one
+    ASSERT_EQ(hipfftExtPlanTrimWorkBuffer(plans[1]), HIPFFT_SUCCESS);
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+    ASSERT_EQ(hipfftExtExecGroup(count, plans, idata, odata, directions, stream), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+    for(int i = 0; i < count; ++i)
+    {
+        std::vector<hipfftComplex> output(expected[i].size());
+        ASSERT_EQ(hipMemcpy(output.data(), odata[i], bytes[i], hipMemcpyDeviceToHost), hipSuccess);
+        for(size_t j = 0; j < output.size(); ++j)
+        {
+            ASSERT_NEAR(output[j].x, expected[i][j].x, 1e-5 * std::abs(expected[i][j].x) + 1e-2);
+            ASSERT_NEAR(output[j].y, expected[i][j].y, 1e-5 * std::abs(expected[i][j].y) + 1e-2);
+        }
+    }
+
+    // a bad entry is caught before anything executes
+    hipfftHandle bad[] = {plans[0], nullptr};
+    EXPECT_EQ(hipfftExtExecGroup(2, bad, idata, odata, directions, stream), HIPFFT_INVALID_PLAN);
+    EXPECT_EQ(hipfftExtExecGroup(-1, plans, idata, odata, directions, stream),
+              HIPFFT_INVALID_VALUE);
+
+    for(int i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(hipfftDestroy(plans[i]), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipFree(idata[i]), hipSuccess);
+        ASSERT_EQ(hipFree(odata[i]), hipSuccess);
+    }
+    ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+}
+
+TEST(hipfftTest, ExecGraph)
+{
+    const int    n        = 256;
+    const int    batch    = 8;
+    const size_t elements = static_cast<size_t>(n) * batch;
+    const size_t bytes    = elements * sizeof(hipfftComplex);
+
+    hipfftHandle plan  = hipfft_params::INVALID_PLAN_HANDLE;
+    hipfftHandle graph = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+    // graphs are captured with a work area of the plan's own
+    ASSERT_EQ(hipfftCreate(&graph), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanWorkBufferMode(graph, HIPFFT_EXT_WORKBUFFER_POOL), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(graph, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+    ASSERT_EQ(hipfftSetStream(graph, stream), HIPFFT_SUCCESS);
+
+    hipfftComplex* d_input      = nullptr;
+    hipfftComplex* d_outputs[2] = {};
+    ASSERT_EQ(hipMalloc(&d_input, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_outputs[0], bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_outputs[1], bytes), hipSuccess);
+
+    // replays see new data behind the same pointers, and new pointers
+    // or directions capture new graphs
+    std::vector<hipfftComplex> input(elements), expected(elements), output(elements);
+    for(int round = 0; round < 4; ++round)
+    {
+        const int  direction = round == 3 ? HIPFFT_BACKWARD : HIPFFT_FORWARD;
+        const auto d_output  = d_outputs[round == 2 ? 1 : 0];
+        for(size_t i = 0; i < elements; ++i)
+            input[i] = {static_cast<float>((i + round) % 5), static_cast<float>(i % 11)};
+        ASSERT_EQ(hipMemcpy(d_input, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+
+        ASSERT_EQ(hipfftXtExec(plan, d_input, d_output, direction), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipMemcpy(expected.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+        ASSERT_EQ(hipMemset(d_output, 0, bytes), hipSuccess);
+
+        ASSERT_EQ(hipfftExtExecGraph(graph, d_input, d_output, direction), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+        ASSERT_EQ(hipMemcpy(output.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+        for(size_t i = 0; i < elements; ++i)
+        {
+            ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+            ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+        }
+    }
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(graph), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_outputs[0]), hipSuccess);
+    ASSERT_EQ(hipFree(d_outputs[1]), hipSuccess);
+}
+
+TEST(hipfftTest, SetStreams)
+{
+    const int    n        = 128;
+    const int    batch    = 37;
+    const size_t elements = static_cast<size_t>(n) * batch;
+    const size_t bytes    = elements * sizeof(hipfftComplex);
+
+    hipfftHandle plan  = hipfft_params::INVALID_PLAN_HANDLE;
+    hipfftHandle split = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftCreate(&split), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(split, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+
+    hipStream_t streams[3] = {};
+    for(auto& stream : streams)
+        ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+    ASSERT_EQ(hipfftExtSetStreams(split, 0, streams), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftExtSetStreams(split, 3, nullptr), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftExtSetStreams(split, 3, streams), HIPFFT_SUCCESS);
+
+    std::vector<hipfftComplex> input(elements);
+    for(size_t i = 0; i < elements; ++i)
+        input[i] = {static_cast<float>(i % 7), static_cast<float>(i % 13)};
+    hipfftComplex* d_input  = nullptr;
+    hipfftComplex* d_output = nullptr;
+    ASSERT_EQ(hipMalloc(&d_input, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_output, bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_input, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+
+    std::vector<hipfftComplex> expected(elements), output(elements);
+    ASSERT_EQ(hipfftExecC2C(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    // the split execution, then going back to one stream
+    for(int round = 0; round < 2; ++round)
+    {
+        ASSERT_EQ(hipMemset(d_output, 0, bytes), hipSuccess);
+        ASSERT_EQ(hipfftExecC2C(split, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipStreamSynchronize(streams[0]), hipSuccess);
+        ASSERT_EQ(hipMemcpy(output.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+        for(size_t i = 0; i < elements; ++i)
+        {
+            ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+            ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+        }
+        ASSERT_EQ(hipfftSetStream(split, streams[0]), HIPFFT_SUCCESS);
+    }
+
+    // the parts share a work area the application provides, if it's
+    // big enough
+    hipfftHandle manual   = hipfft_params::INVALID_PLAN_HANDLE;
+    size_t       workSize = 0;
+    ASSERT_EQ(hipfftCreate(&manual), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftSetAutoAllocation(manual, 0), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(manual, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtSetStreams(manual, 3, streams), HIPFFT_SUCCESS);
+    void* work = nullptr;
+    ASSERT_EQ(hipMalloc(&work, std::max(workSize, size_t(1))), hipSuccess);
+    ASSERT_EQ(hipfftSetWorkArea(manual, work), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemset(d_output, 0, bytes), hipSuccess);
+    auto res = hipfftExecC2C(manual, d_input, d_output, HIPFFT_FORWARD);
+    if(res == HIPFFT_NO_WORKSPACE)
+    {
+        size_t needed = 0;
+        ASSERT_EQ(hipfftGetSize(manual, &needed), HIPFFT_SUCCESS);
+        ASSERT_GT(needed, workSize);
+        ASSERT_EQ(hipFree(work), hipSuccess);
+        ASSERT_EQ(hipMalloc(&work, needed), hipSuccess);
+        ASSERT_EQ(hipfftSetWorkArea(manual, work), HIPFFT_SUCCESS);
+        res = hipfftExecC2C(manual, d_input, d_output, HIPFFT_FORWARD);
+    }
+    ASSERT_EQ(res, HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamSynchronize(streams[0]), hipSuccess);
+    ASSERT_EQ(hipMemcpy(output.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+    for(size_t i = 0; i < elements; ++i)
+    {
+        ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+        ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+    }
+    ASSERT_EQ(hipfftDestroy(manual), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(work), hipSuccess);
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(split), HIPFFT_SUCCESS);
+    for(auto stream : streams)
+        ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_output), hipSuccess);
+}
+
+TEST(hipfftTest, ExecGraphSetStreams)
+{
+    const int    n        = 128;
+    const int    batch    = 12;
+    const size_t elements = static_cast<size_t>(n) * batch;
+    const size_t bytes    = elements * sizeof(hipfftComplex);
+
+    hipfftHandle plan  = hipfft_params::INVALID_PLAN_HANDLE;
+    hipfftHandle graph = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftCreate(&graph), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(graph, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+
+    hipStream_t streams[4] = {};
+    for(auto& stream : streams)
+        ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+
+    std::vector<hipfftComplex> input(elements);
+    for(size_t i = 0; i < elements; ++i)
+        input[i] = {static_cast<float>(i % 7), static_cast<float>(i % 13)};
+    hipfftComplex* d_input  = nullptr;
+    hipfftComplex* d_output = nullptr;
+    ASSERT_EQ(hipMalloc(&d_input, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_output, bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_input, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+
+    std::vector<hipfftComplex> expected(elements), output(elements);
+    ASSERT_EQ(hipfftExecC2C(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    auto check = [&]() {
+        ASSERT_EQ(hipMemset(d_output, 0, bytes), hipSuccess);
+        ASSERT_EQ(hipfftExtExecGraph(graph, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+        ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+        ASSERT_EQ(hipMemcpy(output.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+        for(size_t i = 0; i < elements; ++i)
+        {
+            ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+            ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+        }
+    };
+
+    // graphs of a split execution are captured again for a new set of
+    // streams, and the old set's streams can go
+    ASSERT_EQ(hipfftExtSetStreams(graph, 2, streams), HIPFFT_SUCCESS);
+    check();
+    hipStream_t others[3] = {streams[0], streams[2], streams[3]};
+    ASSERT_EQ(hipfftExtSetStreams(graph, 3, others), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipStreamDestroy(streams[1]), hipSuccess);
+    streams[1] = nullptr;
+    check();
+    ASSERT_EQ(hipfftSetStream(graph, streams[0]), HIPFFT_SUCCESS);
+    check();
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(graph), HIPFFT_SUCCESS);
+    for(auto stream : streams)
+        if(stream)
+            ASSERT_EQ(hipStreamDestroy(stream), hipSuccess);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_output), hipSuccess);
+}
+
+TEST(hipfftTest, ExecBatch)
+{
+    const int    n        = 64;
+    const int    batch    = 16;
+    const size_t elements = static_cast<size_t>(n) * batch;
+    const size_t bytes    = elements * sizeof(hipfftDoubleComplex);
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_Z2Z, batch, nullptr), HIPFFT_SUCCESS);
+
+    std::vector<hipfftDoubleComplex> input(elements);
+    for(size_t i = 0; i < elements; ++i)
+        input[i] = {static_cast<double>(i % 9), static_cast<double>(i % 4)};
+    hipfftDoubleComplex* d_input  = nullptr;
+    hipfftDoubleComplex* d_output = nullptr;
+    ASSERT_EQ(hipMalloc(&d_input, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_output, bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_input, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+
+    std::vector<hipfftDoubleComplex> expected(elements), output(elements);
+    ASSERT_EQ(hipfftExecZ2Z(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    ASSERT_EQ(hipfftExtExecBatch(plan, d_input, d_output, HIPFFT_FORWARD, 0),
+              HIPFFT_INVALID_SIZE);
+    ASSERT_EQ(hipfftExtExecBatch(plan, d_input, d_output, HIPFFT_FORWARD, batch + 1),
+              HIPFFT_INVALID_SIZE);
+
+    // transforms past nbatch are left alone; batch counts repeat to
+    // reuse cached sub-plans
+    const int nbatches[] = {5, 1, 16, 5, 11};
+    for(auto nbatch : nbatches)
+    {
+        const size_t count = static_cast<size_t>(n) * nbatch;
+        ASSERT_EQ(hipMemset(d_output, 0, bytes), hipSuccess);
+        ASSERT_EQ(hipfftExtExecBatch(plan, d_input, d_output, HIPFFT_FORWARD, nbatch),
+                  HIPFFT_SUCCESS);
+        ASSERT_EQ(hipMemcpy(output.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+        for(size_t i = 0; i < elements; ++i)
+        {
+            const auto e = i < count ? expected[i] : hipfftDoubleComplex{0.0, 0.0};
+            ASSERT_NEAR(output[i].x, e.x, 1e-5 * std::abs(e.x) + 1e-2);
+            ASSERT_NEAR(output[i].y, e.y, 1e-5 * std::abs(e.y) + 1e-2);
+        }
+    }
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_output), hipSuccess);
+}
+
+TEST(hipfftTest, ExecScaled)
+{
+    const int    n        = 256;
+    const int    batch    = 4;
+    const size_t elements = static_cast<size_t>(n) * batch;
+    const size_t bytes    = elements * sizeof(hipfftComplex);
+
+    std::vector<hipfftComplex> input(elements);
+    for(size_t i = 0; i < elements; ++i)
+        input[i] = {static_cast<float>(i % 6), static_cast<float>(i % 10)};
+    hipfftComplex* d_input  = nullptr;
+    hipfftComplex* d_output = nullptr;
+    ASSERT_EQ(hipMalloc(&d_input, bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_output, bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(d_input, input.data(), bytes, hipMemcpyHostToDevice), hipSuccess);
+
+    // reference result, with the plan's own factor
+    hipfftHandle reference = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&reference), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanScaleFactor(reference, 0.5), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(reference, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+    std::vector<hipfftComplex> expected(elements), output(elements);
+    ASSERT_EQ(hipfftExecC2C(reference, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+    ASSERT_EQ(hipfftDestroy(reference), HIPFFT_SUCCESS);
+
+    // the factors are checked, and set before planning
+    const double nan       = std::numeric_limits<double>::quiet_NaN();
+    const double invalid[] = {2.0, nan};
+    const double scales[]  = {2.0, -0.25, 1.0, 2.0};
+    hipfftHandle plan      = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanScaleDynamic(plan, -1, scales), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftExtPlanScaleDynamic(plan, 2, nullptr), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftExtPlanScaleDynamic(plan, 2, invalid), HIPFFT_INVALID_VALUE);
+    ASSERT_EQ(hipfftExtPlanScaleFactor(plan, 0.5), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanScaleDynamic(plan, 4, scales), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanLazy(plan, 1), HIPFFT_SUCCESS);
+    size_t workSize = 0;
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, &workSize), HIPFFT_SUCCESS);
+
+    // the work area covers every factor up front, even for a lazy plan
+    size_t size = 0;
+    ASSERT_EQ(hipfftGetSize(plan, &size), HIPFFT_SUCCESS);
+    EXPECT_EQ(size, workSize);
+
+    ASSERT_EQ(hipfftExtExecScaled(plan, d_input, d_output, HIPFFT_FORWARD, 3.0),
+              HIPFFT_INVALID_VALUE);
+
+    auto check = [&](hipfftHandle exec, double scale) {
+        ASSERT_EQ(hipfftExtExecScaled(exec, d_input, d_output, HIPFFT_FORWARD, scale),
+                  HIPFFT_SUCCESS);
+        ASSERT_EQ(hipMemcpy(output.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+        const double ratio = scale / 0.5;
+        for(size_t i = 0; i < elements; ++i)
+        {
+            const double ex = expected[i].x * ratio;
+            const double ey = expected[i].y * ratio;
+            ASSERT_NEAR(output[i].x, ex, 1e-5 * std::abs(ex) + 1e-2);
+            ASSERT_NEAR(output[i].y, ey, 1e-5 * std::abs(ey) + 1e-2);
+        }
+    };
+
+    // the planned factor and each dynamic one, on the plan and a
+    // clone of it
+    hipfftHandle clone = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftExtPlanClone(plan, &clone), HIPFFT_SUCCESS);
+    for(auto exec : {plan, clone})
+    {
+        for(auto scale : {0.5, 2.0, -0.25, 1.0})
+            check(exec, scale);
+    }
+
+    // ordinary executions keep the planned factor
+    ASSERT_EQ(hipfftExecC2C(plan, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(output.data(), d_output, bytes, hipMemcpyDeviceToHost), hipSuccess);
+    for(size_t i = 0; i < elements; ++i)
+    {
+        ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+        ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+    }
+
+    // the factors carry over a change of batch
+    ASSERT_EQ(hipfftExtSetBatch(plan, 1), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtExecScaled(plan, d_input, d_output, HIPFFT_FORWARD, -0.25),
+              HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(output.data(), d_output, n * sizeof(hipfftComplex), hipMemcpyDeviceToHost),
+              hipSuccess);
+    for(int i = 0; i < n; ++i)
+    {
+        const double ex = expected[i].x * -0.5;
+        const double ey = expected[i].y * -0.5;
+        ASSERT_NEAR(output[i].x, ex, 1e-5 * std::abs(ex) + 1e-2);
+        ASSERT_NEAR(output[i].y, ey, 1e-5 * std::abs(ey) + 1e-2);
+    }
+
+    ASSERT_EQ(hipfftDestroy(clone), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_output), hipSuccess);
+}
+
+TEST(hipfftTest, AsyncReplan)
+{
+    long long int n     = 64;
+    const int     batch = 8;
+    const int     part  = 3;
+
+    hipfftHandle plan = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(plan, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+
+    const size_t   max_bytes = 128 * batch * sizeof(hipfftComplex);
+    hipfftComplex* d_input   = nullptr;
+    hipfftComplex* d_output  = nullptr;
+    ASSERT_EQ(hipMalloc(&d_input, max_bytes), hipSuccess);
+    ASSERT_EQ(hipMalloc(&d_output, max_bytes), hipSuccess);
+    ASSERT_EQ(hipMemset(d_input, 0, max_bytes), hipSuccess);
+    ASSERT_EQ(hipfftExtExecBatch(plan, d_input, d_output, HIPFFT_FORWARD, part), HIPFFT_SUCCESS);
+
+    // a background re-plan replaces the partial-batch plans of the
+    // previous one
+    n               = 128;
+    auto make_async = [&](hipfftHandle handle) {
+        return hipfftExtMakePlanManyAsync(
+            handle, 1, &n, nullptr, 1, n, HIP_C_32F, nullptr, 1, n, HIP_C_32F, batch, HIP_C_32F);
+    };
+    ASSERT_EQ(make_async(plan), HIPFFT_SUCCESS);
+
+    const size_t               elements = static_cast<size_t>(n) * batch;
+    std::vector<hipfftComplex> input(elements);
+    for(size_t i = 0; i < elements; ++i)
+        input[i] = {static_cast<float>(i % 3), static_cast<float>(i % 8)};
+    ASSERT_EQ(hipMemcpy(d_input, input.data(), max_bytes, hipMemcpyHostToDevice), hipSuccess);
+
+    hipfftHandle reference = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&reference), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftMakePlan1d(reference, n, HIPFFT_C2C, batch, nullptr), HIPFFT_SUCCESS);
+    std::vector<hipfftComplex> expected(elements), output(elements);
+    ASSERT_EQ(hipfftExecC2C(reference, d_input, d_output, HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(expected.data(), d_output, max_bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    ASSERT_EQ(hipMemset(d_output, 0, max_bytes), hipSuccess);
+    ASSERT_EQ(hipfftExtExecBatch(plan, d_input, d_output, HIPFFT_FORWARD, part), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipMemcpy(output.data(), d_output, max_bytes, hipMemcpyDeviceToHost), hipSuccess);
+    for(size_t i = 0; i < elements; ++i)
+    {
+        const auto e = i < static_cast<size_t>(n) * part ? expected[i] : hipfftComplex{0.0f, 0.0f};
+        ASSERT_NEAR(output[i].x, e.x, 1e-5 * std::abs(e.x) + 1e-2);
+        ASSERT_NEAR(output[i].y, e.y, 1e-5 * std::abs(e.y) + 1e-2);
+    }
+
+    // out-of-core plans can be made in the background too
+    hipfftHandle ooc = hipfft_params::INVALID_PLAN_HANDLE;
+    ASSERT_EQ(hipfftCreate(&ooc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanOutOfCore(ooc, 1), HIPFFT_SUCCESS);
+    ASSERT_EQ(make_async(ooc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftExtPlanWait(ooc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftXtExec(ooc, input.data(), output.data(), HIPFFT_FORWARD), HIPFFT_SUCCESS);
+    for(size_t i = 0; i < elements; ++i)
+    {
+        ASSERT_NEAR(output[i].x, expected[i].x, 1e-5 * std::abs(expected[i].x) + 1e-2);
+        ASSERT_NEAR(output[i].y, expected[i].y, 1e-5 * std::abs(expected[i].y) + 1e-2);
+    }
+
+    ASSERT_EQ(hipfftDestroy(plan), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(reference), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipfftDestroy(ooc), HIPFFT_SUCCESS);
+    ASSERT_EQ(hipFree(d_input), hipSuccess);
+    ASSERT_EQ(hipFree(d_output), hipSuccess);
+}
+#endif
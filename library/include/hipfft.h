@@ -95,7 +95,9 @@ typedef enum hipfftResult_t
     /*! Function does not implement functionality for parameters given. */
     HIPFFT_NOT_IMPLEMENTED = 14,
     /*! Operation is not supported for parameters given. */
-    HIPFFT_NOT_SUPPORTED = 16
+    HIPFFT_NOT_SUPPORTED = 16,
+    /*! Plan is still being created in the background. */
+    HIPFFT_PLAN_NOT_READY = 0x100
 } hipfftResult;
 
 /*! @brief Transform type
@@ -137,6 +139,145 @@ typedef int hipfftHandle;
 typedef struct hipfftHandle_t* hipfftHandle;
 #endif
 
+/*! @brief Group of plans that share one work area
+ *  @details See ::hipfftExtWorkAreaGroupCreate.
+ *  */
+typedef struct hipfftExtWorkAreaGroup_t* hipfftExtWorkAreaGroup;
+
+/*! @brief Placements a plan will be executed with
+ *  @details Values can be combined with bitwise OR.  See ::hipfftExtPlanHints.
+ *  */
+typedef enum hipfftExtPlacement_t
+{
+    /*! In-place execution (input and output buffers are equal) */
+    HIPFFT_EXT_PLACEMENT_INPLACE = 0x1,
+    /*! Out-of-place execution (input and output buffers differ) */
+    HIPFFT_EXT_PLACEMENT_NOTINPLACE = 0x2,
+    /*! Either placement */
+    HIPFFT_EXT_PLACEMENT_ALL = 0x3
+} hipfftExtPlacement;
+
+/*! @brief Directions a plan will be executed with
+ *  @details Values can be combined with bitwise OR.  See ::hipfftExtPlanHints.
+ *  */
+typedef enum hipfftExtDirection_t
+{
+    /*! Forward transforms */
+    HIPFFT_EXT_DIRECTION_FORWARD = 0x1,
+    /*! Backward/inverse transforms */
+    HIPFFT_EXT_DIRECTION_BACKWARD = 0x2,
+    /*! Either direction */
+    HIPFFT_EXT_DIRECTION_ALL = 0x3
+} hipfftExtDirection;
+
+/*! @brief Statistics for the process-wide plan cache
+ *  @details See ::hipfftExtPlanCacheGetStats.
+ *  */
+typedef struct hipfftExtPlanCacheStats_t
+{
+    /*! Number of sub-plan requests satisfied by an existing plan */
+    size_t hits;
+    /*! Number of sub-plan requests that needed a new plan to be created */
+    size_t misses;
+    /*! Number of plans removed from the cache */
+    size_t evictions;
+    /*! Number of plans currently held by the cache */
+    size_t entries;
+    /*! Maximum number of plans the cache will hold */
+    size_t capacity;
+} hipfftExtPlanCacheStats;
+
+/*! @brief How a plan's automatically-allocated work area is managed
+ *  @details See ::hipfftExtPlanWorkBufferMode.
+ *  */
+typedef enum hipfftExtWorkBufferMode_t
+{
+    /*! Allocated when the plan is initialized, and kept until it is destroyed */
+    HIPFFT_EXT_WORKBUFFER_EAGER = 0,
+    /*! Borrowed from a process-wide pool for each execution */
+    HIPFFT_EXT_WORKBUFFER_POOL = 1,
+    /*! Allocated on first execution, and kept until the plan is trimmed or destroyed */
+    HIPFFT_EXT_WORKBUFFER_DEFERRED = 2,
+    /*! As ::HIPFFT_EXT_WORKBUFFER_DEFERRED, but allocated and freed in stream order */
+    HIPFFT_EXT_WORKBUFFER_DEFERRED_ASYNC = 3
+} hipfftExtWorkBufferMode;
+
+/*! @brief Statistics for the process-wide work area pool
+ *  @details See ::hipfftExtWorkBufferPoolGetStats.  Sizes are in bytes.
+ *  */
+typedef struct hipfftExtWorkBufferPoolStats_t
+{
+    /*! Device memory currently allocated by the pool */
+    size_t bytes_allocated;
+    /*! Device memory currently borrowed by executing plans */
+    size_t bytes_in_use;
+    /*! Peak device memory allocated by the pool */
+    size_t high_water_bytes;
+    /*! Number of device allocations the pool has made */
+    size_t allocations;
+    /*! Number of times a work area was reused instead of allocated */
+    size_t reuses;
+} hipfftExtWorkBufferPoolStats;
+
+/*! @brief Statistics for the process-wide pinned staging pool
+ *  @details See ::hipfftExtPinnedPoolGetStats.  Sizes are in bytes.
+ *  */
+typedef struct hipfftExtPinnedPoolStats_t
+{
+    /*! Most pinned host memory the pool may allocate */
+    size_t bytes_limit;
+    /*! Pinned host memory currently allocated by the pool */
+    size_t bytes_allocated;
+    /*! Pinned host memory currently used by copies */
+    size_t bytes_in_use;
+    /*! Peak pinned host memory allocated by the pool */
+    size_t high_water_bytes;
+    /*! Number of pinned allocations the pool has made */
+    size_t allocations;
+    /*! Number of times a buffer was reused instead of allocated */
+    size_t reuses;
+    /*! Number of copies made directly from pageable memory because the pool was at its limit */
+    size_t fallbacks;
+} hipfftExtPinnedPoolStats;
+
+/*! @brief Function the library calls when it can't allocate device memory
+ *  @details See ::hipfftExtSetMemoryPressureCallback.
+ *  @param[in] bytes Size of the allocation that failed.
+ *  @param[in] user_data Pointer given when the callback was set.
+ *  @return Nonzero to have the allocation tried again, 0 to let it fail.
+ *  */
+typedef int (*hipfftExtMemoryPressureCallback)(size_t bytes, void* user_data);
+
+/*! @brief Managed memory prefetching done for a plan
+ *  @details See ::hipfftExtPlanPrefetchManaged.
+ *  */
+typedef struct hipfftExtPrefetchStats_t
+{
+    /*! Total bytes of managed memory prefetched before executions */
+    size_t bytes_prefetched;
+    /*! Number of prefetches issued */
+    size_t prefetches;
+} hipfftExtPrefetchStats;
+
+/*! @brief Time spent creating a plan's backend plans
+ *  @details See ::hipfftExtPlanGetBuildMetrics.  Times are in
+ *  seconds.  Backend plans that were not created (for example,
+ *  because of hints or lazy creation) report zero.
+ *  */
+typedef struct hipfftExtPlanBuildMetrics_t
+{
+    /*! Wall-clock time spent creating all backend plans */
+    double total_seconds;
+    /*! Time spent creating the in-place forward backend plan */
+    double inplace_forward_seconds;
+    /*! Time spent creating the out-of-place forward backend plan */
+    double outofplace_forward_seconds;
+    /*! Time spent creating the in-place backward backend plan */
+    double inplace_backward_seconds;
+    /*! Time spent creating the out-of-place backward backend plan */
+    double outofplace_backward_seconds;
+} hipfftExtPlanBuildMetrics;
+
 typedef hipComplex       hipfftComplex;
 typedef hipDoubleComplex hipfftDoubleComplex;
 typedef float            hipfftReal;
@@ -253,6 +394,650 @@ HIPFFT_EXPORT hipfftResult hipfftCreate(hipfftHandle* plan);
  */
 HIPFFT_EXPORT hipfftResult hipfftExtPlanScaleFactor(hipfftHandle plan, double scalefactor);
 
+/*! @brief Set other scale factors a plan can be executed with.
+ *
+ *  @details ::hipfftExtExecScaled executes the plan with one of
+ *  these factors instead of the one set with
+ *  ::hipfftExtPlanScaleFactor.  Like that function, this must be
+ *  called before the plan is initialized.  Initialization then
+ *  creates backend plans for each factor along with the plan's own,
+ *  and sizes the work area for all of them, so executions never
+ *  create or free plans.  Plans with dynamic scale factors create
+ *  all of their backend plans up front, even if they are lazy (see
+ *  ::hipfftExtPlanLazy).
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] count Number of factors, or 0 to remove them.
+ *  @param[in] scales Array of count factors.  Each must be finite.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanScaleDynamic(hipfftHandle plan,
+                                                     int          count,
+                                                     const double scales[]);
+
+/*! @brief Create sub-plans lazily.
+ *
+ *  @details Since the placement (in-place or out-of-place) and
+ *  direction of a transform are only known at execution time, hipFFT
+ *  normally creates backend plans for every placement and direction
+ *  when the plan is initialized.  If lazy creation is enabled, each
+ *  backend plan is instead created the first time it is executed, so
+ *  plans that are only ever executed one way are cheaper to create
+ *  and use less memory.
+ *
+ *  The work area size reported by "MakePlan" and ::hipfftGetSize
+ *  only covers the backend plans created so far.  Automatically
+ *  allocated work areas grow as needed.  If auto-allocation is
+ *  disabled and a newly created backend plan needs a bigger work
+ *  area than the plan has, execution returns ::HIPFFT_NO_WORKSPACE;
+ *  the caller can then query the new size with ::hipfftGetSize,
+ *  provide a bigger work area and execute again.
+ *
+ *  Invalid transform parameters are detected at execution time
+ *  instead of during plan initialization.
+ *
+ *  This function must be called after the plan is allocated using
+ *  ::hipfftCreate, but before the plan is initialized by any of the
+ *  "MakePlan" functions.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] lazy 0 to create all sub-plans up front, non-zero to create them on first use.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanLazy(hipfftHandle plan, int lazy);
+
+/*! @brief Declare how a plan will be executed.
+ *
+ *  @details By default, hipFFT prepares a plan to be executed in
+ *  either placement and (for complex-to-complex transforms) either
+ *  direction, and sizes the work area for the most demanding of
+ *  these.  Hints restrict the plan to only the given placements and
+ *  directions, so that plan creation is cheaper and the work area
+ *  is only as big as those executions need.
+ *
+ *  Executing the plan with a placement or direction that was not
+ *  hinted fails.
+ *
+ *  This function must be called after the plan is allocated using
+ *  ::hipfftCreate, but before the plan is initialized by any of the
+ *  "MakePlan" functions.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] placement_mask Bitwise OR of ::hipfftExtPlacement values.
+ *  @param[in] direction_mask Bitwise OR of ::hipfftExtDirection values.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanHints(hipfftHandle plan,
+                                              int          placement_mask,
+                                              int          direction_mask);
+
+/*! @brief Create a plan's backend plans concurrently.
+ *
+ *  @details A plan needs up to four backend plans: one for each
+ *  placement and direction it may be executed with.  By default
+ *  they are created one after another.  Enabling concurrent
+ *  creation builds them in parallel on an internal pool of worker
+ *  threads, which reduces plan creation time when several of them
+ *  need runtime kernel compilation.
+ *
+ *  This function must be called after the plan is allocated using
+ *  ::hipfftCreate, but before the plan is initialized by any of the
+ *  "MakePlan" functions.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] concurrent Non-zero to create backend plans concurrently, 0 to create them in turn.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanConcurrentBuild(hipfftHandle plan, int concurrent);
+
+/*! @brief Get the time spent creating a plan's backend plans.
+ *
+ *  @details Backend plans that were found in the plan cache take
+ *  almost no time to create.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[out] metrics Time spent creating each backend plan, and in total.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanGetBuildMetrics(hipfftHandle               plan,
+                                                        hipfftExtPlanBuildMetrics* metrics);
+
+/*! @brief Change the number of transforms an initialized plan
+ *  performs.
+ *
+ *  @details Re-plans for a new batch count without repeating the
+ *  rest of plan initialization.  Lengths, strides, distances, data
+ *  types and other settings are kept.  Backend plans for batch
+ *  counts that were planned before are reused from the plan cache,
+ *  and new ones reuse the backend's already-compiled kernels.
+ *
+ *  An automatically-allocated work area is only reallocated if the
+ *  new batch count needs a bigger one.  If auto-allocation is
+ *  disabled, the caller must query the new size with
+ *  ::hipfftGetSize and provide a big enough work area before
+ *  executing the plan.
+ *
+ *  If re-planning fails, the plan keeps its previous batch count.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] batch Number of batched transforms to perform, at least 1.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetBatch(hipfftHandle plan, long long int batch);
+
+/*! @brief Create a copy of an initialized plan.
+ *
+ *  @details The copy shares the backend plans of the source plan,
+ *  so no backend plans are created.  It gets its own work area,
+ *  stream and callbacks, so that the same transform can be executed
+ *  concurrently on several streams without planning it again.
+ *
+ *  The copy starts out with the source plan's scale factor, hints,
+ *  auto-allocation setting and callbacks.  It executes on the
+ *  default stream until ::hipfftSetStream is called on it.  If
+ *  auto-allocation is enabled, a new work area is allocated for the
+ *  copy.  Otherwise, a work area must be provided with
+ *  ::hipfftSetWorkArea before executing it.
+ *
+ *  The copy must be destroyed with ::hipfftDestroy.  Destroying the
+ *  source plan does not affect it.
+ *
+ *  @param[in] src Handle of the FFT plan to copy.
+ *  @param[out] dst Pointer to the new FFT plan handle.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanClone(hipfftHandle src, hipfftHandle* dst);
+
+/*! @brief Choose how a plan's automatically-allocated work area is
+ *  managed.
+ *
+ *  @details By default (::HIPFFT_EXT_WORKBUFFER_EAGER), each plan
+ *  allocates its own work area when it is initialized, and keeps it
+ *  until the plan is destroyed.
+ *
+ *  With ::HIPFFT_EXT_WORKBUFFER_POOL, the plan instead borrows a
+ *  work area from a process-wide pool each time it is executed, and
+ *  returns it once the execution is enqueued.  Borrowing is ordered
+ *  on the plan's stream, so the host never waits for a work area to
+ *  become free.  Plans that don't execute concurrently end up
+ *  sharing the same device memory.
+ *
+ *  With ::HIPFFT_EXT_WORKBUFFER_DEFERRED, the plan allocates its
+ *  work area the first time it is executed, so plans that are never
+ *  executed use no work area at all.
+ *  ::HIPFFT_EXT_WORKBUFFER_DEFERRED_ASYNC also makes that allocation,
+ *  and the matching free, ordered on the plan's stream.  Changing the
+ *  stream with ::hipfftSetStream frees the work area on the old
+ *  stream, and the next execution allocates one on the new stream.
+ *  ::hipfftExtExecGroup orders the group's stream with the work
+ *  area's own.
+ *
+ *  This has no effect on plans given a work area with
+ *  ::hipfftSetWorkArea.  It may be called before or after the plan
+ *  is initialized.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] mode Work area management mode.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanWorkBufferMode(hipfftHandle            plan,
+                                                       hipfftExtWorkBufferMode mode);
+
+/*! @brief Limit the work area a plan may use.
+ *
+ *  @details If the work area needed to execute the plan's full batch
+ *  at once would be larger than the limit, the plan is created for a
+ *  smaller batch that fits, and each execution runs the full batch
+ *  as several smaller ones, one after the other on the plan's
+ *  stream.  Plans that cannot fit within the limit even one
+ *  transform at a time fail with ::HIPFFT_ALLOC_FAILED.
+ *
+ *  Load and store callbacks of a split batch see offsets relative to
+ *  the start of each piece.
+ *
+ *  Must be called before the plan is initialized, or before
+ *  ::hipfftExtSetBatch, to take effect.  Plans with a limit create
+ *  their sub-plans when initialized even if ::hipfftExtPlanLazy was
+ *  requested.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] bytes Largest work area the plan may use, or 0 for no limit.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetMemoryLimit(hipfftHandle plan, size_t bytes);
+
+/*! @brief Prefetch managed memory before executing a plan.
+ *
+ *  @details When enabled, each execution checks whether its input,
+ *  output and caller-provided work area were allocated with
+ *  hipMallocManaged.  Those that were are prefetched to the plan's
+ *  device on the plan's stream before the transform runs, rather
+ *  than being migrated page by page as the transform's kernels touch
+ *  them.  Executions split across streams by ::hipfftExtSetStreams
+ *  prefetch on the first stream, which the others wait for.
+ *
+ *  Disabled by default, since checking pointers adds a little to
+ *  each execution.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] prefetch 1 to enable prefetching, 0 to disable it.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanPrefetchManaged(hipfftHandle plan, int prefetch);
+
+/*! @brief Get managed memory prefetch statistics for a plan.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[out] stats Bytes and number of prefetches issued by the plan's executions.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanGetPrefetchStats(hipfftHandle            plan,
+                                                         hipfftExtPrefetchStats* stats);
+
+/*! @brief Let a plan execute directly on host memory.
+ *
+ *  @details With staging enabled, ::hipfftXtExec and the
+ *  hipfftExec* functions accept input and output pointers to host
+ *  memory.  The batch is split into chunks, which rotate through a
+ *  ring of device buffers, each with its own stream.  Copying one
+ *  chunk to the device, transforming another and copying a third
+ *  back all overlap.  The ring's buffers are allocated on the first
+ *  staged execution and kept until the plan is destroyed.
+ *
+ *  As with device data, executions are asynchronous: results are
+ *  available once the plan's stream has been synchronized.  Pageable
+ *  host memory, rather than memory pinned by hipHostMalloc or
+ *  hipHostRegister, is copied through buffers from the pinned staging
+ *  pool (see ::hipfftExtPinnedPoolSetLimit).  Executions writing to
+ *  pageable memory return once their output is complete.  Data
+ *  between transforms in an out-of-place host output buffer may be
+ *  overwritten.
+ *
+ *  Executions where both pointers are device memory are unaffected.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] depth Number of device buffers and streams to stage
+ *  through, or 0 to disable staging.
+ *  @param[in] chunk Number of transforms in each chunk, or 0 to
+ *  split the batch evenly between two rounds of the ring.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanHostStaging(hipfftHandle  plan,
+                                                    int           depth,
+                                                    long long int chunk);
+
+/*! @brief Make plans for transforms too big for device memory.
+ *
+ *  @details Plans made by ::hipfftMakePlanMany, ::hipfftMakePlanMany64
+ *  or ::hipfftXtMakePlanMany after this is enabled keep their data in
+ *  host memory, and transform it in passes that each move a chunk
+ *  at a time through the device.  1D transforms are factored as
+ *  N = N1 * N2 and done with the four-step algorithm, so N must not
+ *  be prime.  2D and 3D transforms first transform each slab of the
+ *  faster dimensions, then the pencils along the slowest one.
+ *
+ *  Chunks are sized so that two of them, and their work areas, fit
+ *  in the plan's memory limit (see ::hipfftExtSetMemoryLimit), or in
+ *  half of the device's free memory if it has none.
+ *
+ *  Only contiguous complex-to-complex single and double precision
+ *  transforms are supported; other plans fail with
+ *  ::HIPFFT_NOT_IMPLEMENTED.  Executions take host pointers and are
+ *  synchronous; device or managed pointers fail with
+ *  ::HIPFFT_INVALID_VALUE.  In-place 1D transforms allocate a pinned
+ *  host buffer the size of one transform.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] enable 1 to make out-of-core plans, 0 to make normal ones.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanOutOfCore(hipfftHandle plan, int enable);
+
+/*! @brief Execute a plan by replaying a captured graph.
+ *
+ *  @details The first execution of a plan with a given input, output
+ *  and direction captures the execution's kernel launches into a HIP
+ *  graph, which is cached on the plan.  That execution, and later
+ *  ones with the same pointers, launch the graph on the plan's
+ *  stream, which costs less host time than ::hipfftXtExec for small
+ *  transforms.  Changing the plan's work area, callbacks or streams
+ *  (see ::hipfftExtSetStreams) makes the next execution capture a new
+ *  graph.  Each plan caches the graphs
+ *  of its 8 most recently used pointer combinations.
+ *
+ *  Plans that borrow work areas from the pool, or allocate them on
+ *  first use, are given a work area of their own, since a graph keeps
+ *  using the same one.  Out-of-core plans, and executions on host
+ *  memory, are not supported.
+ *
+ *  Ordinary executions may also be captured by the application:
+ *  they give plans work areas of their own the same way, but fail
+ *  with ::HIPFFT_NOT_SUPPORTED on host memory.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] idata Input buffer.
+ *  @param[out] odata Output buffer.
+ *  @param[in] direction ::HIPFFT_FORWARD or ::HIPFFT_BACKWARD.  Ignored for real transforms.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtExecGraph(hipfftHandle plan,
+                                              void*        idata,
+                                              void*        odata,
+                                              int          direction);
+
+/*! @brief Execute the first transforms of a plan's batch.
+ *
+ *  @details Behaves like ::hipfftXtExec, but only transforms the
+ *  first nbatch elements of the batch the plan was made for, without
+ *  re-planning.  Each plan keeps the backend plans for the 4 batch
+ *  counts it executed most recently, and takes new ones from the
+ *  plan cache.  If a smaller batch needs a larger work area, the plan
+ *  allocates one as if it were lazy (see ::hipfftExtPlanLazy), or
+ *  fails with ::HIPFFT_NO_WORKSPACE if the application provides it.
+ *
+ *  Out-of-core plans are not supported.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] idata Input buffer.
+ *  @param[out] odata Output buffer.
+ *  @param[in] direction ::HIPFFT_FORWARD or ::HIPFFT_BACKWARD.  Ignored for real transforms.
+ *  @param[in] nbatch Number of transforms to execute, from 1 to the plan's batch.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtExecBatch(
+    hipfftHandle plan, void* idata, void* odata, int direction, long long int nbatch);
+
+/*! @brief Execute a plan with a different scale factor.
+ *
+ *  @details Behaves like ::hipfftXtExec, but multiplies each element
+ *  of the result by the given factor instead of the plan's scale
+ *  factor, without re-planning.  The scaling is part of the
+ *  transform, so it does not add a pass over the output.
+ *
+ *  The factor must be the plan's own, or one of those set with
+ *  ::hipfftExtPlanScaleDynamic before the plan was initialized;
+ *  otherwise ::HIPFFT_INVALID_VALUE is returned.  Out-of-core plans
+ *  are not supported.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] idata Input buffer.
+ *  @param[out] odata Output buffer.
+ *  @param[in] direction ::HIPFFT_FORWARD or ::HIPFFT_BACKWARD.  Ignored for real transforms.
+ *  @param[in] scale Scale factor for this execution.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtExecScaled(
+    hipfftHandle plan, void* idata, void* odata, int direction, double scale);
+
+/*! @brief Split a plan's executions across several streams.
+ *
+ *  @details Each execution divides the plan's batch into up to
+ *  count equal parts, using the plan's input and output distances,
+ *  and runs one part on each stream.  Each part has its own slice of
+ *  the plan's work area.  The parts start after work already
+ *  submitted to the first stream, and work submitted to the first
+ *  stream afterwards waits for all of them, so the execution behaves
+ *  as if it ran on the first stream alone.
+ *
+ *  If the slices don't fit in the plan's work area, an automatically
+ *  allocated one grows, as if the plan were lazy (see
+ *  ::hipfftExtPlanLazy).  With a work area provided by the
+ *  application, the execution fails with ::HIPFFT_NO_WORKSPACE, and
+ *  ::hipfftGetSize reports the size needed.  Executions captured
+ *  into a graph by the application fail with ::HIPFFT_NOT_SUPPORTED
+ *  instead of growing the work area.
+ *
+ *  The first stream becomes the plan's stream.  Calling
+ *  ::hipfftSetStream, or this function with a count of 1, returns
+ *  the plan to running on one stream.  Plans whose batch is already
+ *  split by ::hipfftExtSetMemoryLimit, plans with load or store
+ *  callbacks, and executions on host memory, run on the first stream
+ *  only.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ *  @param[in] count Number of streams.
+ *  @param[in] streams Streams to run on.  They must remain valid until
+ *  the plan is destroyed or returned to one stream.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetStreams(hipfftHandle plan,
+                                               int          count,
+                                               hipStream_t  streams[]);
+
+/*! @brief Execute several plans, one after the other, on a stream.
+ *
+ *  @details Equivalent to calling ::hipfftXtExec for each plan in
+ *  turn, with each plan's stream temporarily set to the given one,
+ *  but with less overhead per plan.  Plans that would otherwise
+ *  borrow a work area from the pool or allocate a deferred one all
+ *  share a single work area, sized for the largest of them.
+ *
+ *  Every entry is checked before anything is executed.  If an
+ *  execution fails, the remaining plans are not executed and its
+ *  status is returned.  Out-of-core plans are not supported.
+ *
+ *  @param[in] count Number of plans to execute.
+ *  @param[in] plans Handles of the FFT plans.
+ *  @param[in] idata Input buffer of each plan.
+ *  @param[out] odata Output buffer of each plan.
+ *  @param[in] directions Direction of each complex-to-complex transform,
+ *  ::HIPFFT_FORWARD or ::HIPFFT_BACKWARD.  Ignored for real transforms.
+ *  @param[in] stream Stream to execute on.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtExecGroup(int          count,
+                                              hipfftHandle plans[],
+                                              void*        idata[],
+                                              void*        odata[],
+                                              const int    directions[],
+                                              hipStream_t  stream);
+
+/*! @brief Free a plan's automatically-allocated work area.
+ *
+ *  @details The plan allocates a new work area the next time it is
+ *  executed, whatever its work area mode.  This lets applications
+ *  give back device memory held by plans that are idle.
+ *
+ *  @param[in] plan Handle of the FFT plan.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanTrimWorkBuffer(hipfftHandle plan);
+
+/*! @brief Free the work area pool's device memory that is not in use.
+ *
+ *  @details Waits for the last execution using each freed work area
+ *  to finish.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtWorkBufferPoolTrim();
+
+/*! @brief Get work area pool statistics.
+ *
+ *  @param[out] stats Current and peak device memory held by the pool, and allocation counts.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtWorkBufferPoolGetStats(hipfftExtWorkBufferPoolStats* stats);
+
+/*! @brief Set the most pinned host memory the staging pool may allocate.
+ *
+ *  @details Executions on pageable host memory, through
+ *  ::hipfftExtPlanHostStaging or ::hipfftExtPlanOutOfCore, copy it
+ *  through pinned buffers from a process-wide pool, which are reused
+ *  from one execution to the next.  Copies that would take the pool
+ *  past its limit are made directly from the pageable memory, at
+ *  lower bandwidth.  The default limit is 256 MiB.
+ *
+ *  Lowering the limit below what the pool has allocated frees the
+ *  buffers that are not in use.
+ *
+ *  @param[in] bytes Most pinned memory the pool may allocate, or 0 to never use it.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPinnedPoolSetLimit(size_t bytes);
+
+/*! @brief Free the staging pool's pinned memory that is not in use.
+ *
+ *  @details Waits for the last copy using each freed buffer to finish.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPinnedPoolTrim();
+
+/*! @brief Get pinned staging pool statistics.
+ *
+ *  @param[out] stats Limit, current and peak pinned memory held by the pool, and allocation counts.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPinnedPoolGetStats(hipfftExtPinnedPoolStats* stats);
+
+/*! @brief Free memory the library holds but is not using.
+ *
+ *  @details Frees the automatically-allocated work areas, and the
+ *  host staging and out-of-core buffers, of plans that are not
+ *  executing at the time.  Those plans allocate them again when
+ *  they are next executed.  Also frees the work area and pinned
+ *  staging pools' idle buffers, and removes plans that no handle is
+ *  using from the plan cache.
+ *
+ *  Caller-provided work areas, and the buffers of work area groups,
+ *  are left alone.  This may be called while other threads execute
+ *  plans, but not while they create or reconfigure them.  The
+ *  library does the same by itself when it runs out of device
+ *  memory, see ::hipfftExtSetMemoryPressureCallback.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtTrimMemory();
+
+/*! @brief Set a function to call when the library runs out of device memory.
+ *
+ *  @details When allocating a work area, or another of the library's
+ *  device buffers, fails, the library first frees the memory it
+ *  holds but is not using, as ::hipfftExtTrimMemory does, and tries
+ *  again.  Plans that are executing, and the plan being allocated
+ *  for, keep their buffers.  If the allocation still fails, the
+ *  callback is called with the size of the allocation, and can free
+ *  memory of the application's own.  If it returns nonzero, the
+ *  allocation is tried again, and the callback is called again if
+ *  it still fails, up to 8 times in all.  Once it returns 0, or
+ *  after the last try, the allocation fails with
+ *  ::HIPFFT_ALLOC_FAILED.
+ *
+ *  The callback is process-wide, and is called on whichever thread
+ *  is allocating.  It may call ::hipfftExtTrimMemory, but must not
+ *  call hipFFT functions that create, execute or destroy plans.
+ *
+ *  @param[in] callback Function to call, or NULL to remove the current one.
+ *  @param[in] user_data Pointer passed to the callback.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtSetMemoryPressureCallback(
+    hipfftExtMemoryPressureCallback callback, void* user_data);
+
+/*! @brief Create a group of plans that share one work area.
+ *
+ *  @details Plans that only ever execute in order on the same
+ *  stream can never use their work areas at the same time, so they
+ *  can share a single buffer sized for the most demanding of them.
+ *  The group allocates and owns that buffer.
+ *
+ *  @param[out] group Pointer to the new group.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtWorkAreaGroupCreate(hipfftExtWorkAreaGroup* group);
+
+/*! @brief Add a plan to a work area group.
+ *
+ *  @details The plan's own work area is freed and it uses the group's
+ *  buffer from then on.  The buffer is reallocated if the plan needs
+ *  more work area than the group currently holds; this includes
+ *  later re-planning of any member, e.g. by ::hipfftExtSetBatch.
+ *  Callers are responsible for executing all plans in a group on the
+ *  same stream.
+ *
+ *  A plan can belong to at most one group.  Plans whose work area is
+ *  provided by the caller, after ::hipfftSetAutoAllocation disabled
+ *  automatic allocation, cannot be added and fail with
+ *  ::HIPFFT_INVALID_VALUE.  Setting the plan's work area with
+ *  ::hipfftSetWorkArea removes it from its group.
+ *
+ *  @param[in] group The work area group.
+ *  @param[in] plan Handle of the plan to add.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtWorkAreaGroupAddPlan(hipfftExtWorkAreaGroup group,
+                                                         hipfftHandle           plan);
+
+/*! @brief Remove a plan from a work area group.
+ *
+ *  @details The plan gets a work area of its own again, and the
+ *  group's buffer shrinks to what the remaining plans need.
+ *  Destroying a plan removes it from its group.
+ *
+ *  @param[in] group The work area group.
+ *  @param[in] plan Handle of the plan to remove.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtWorkAreaGroupRemovePlan(hipfftExtWorkAreaGroup group,
+                                                            hipfftHandle           plan);
+
+/*! @brief Get the size of a work area group's buffer.
+ *
+ *  @param[in] group The work area group.
+ *  @param[out] size Size of the shared work area, in bytes.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtWorkAreaGroupGetSize(hipfftExtWorkAreaGroup group,
+                                                         size_t*                size);
+
+/*! @brief Destroy a work area group.
+ *
+ *  @details Remaining plans in the group get work areas of their own.
+ *
+ *  @param[in] group The work area group.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtWorkAreaGroupDestroy(hipfftExtWorkAreaGroup group);
+
+/*! @brief Set the capacity of the plan cache.
+ *
+ *  @details hipFFT keeps a process-wide cache of the backend plans
+ *  it creates.  "MakePlan" functions that are given the same
+ *  transform parameters (dimensions, lengths, strides, distances,
+ *  data types, batch count, scale factor and device) share the
+ *  cached backend plans, instead of building new ones.  Each plan
+ *  handle still gets its own work area, stream and callbacks.
+ *
+ *  Once the cache holds more than capacity plans, the least
+ *  recently used ones are evicted.  Plan handles that are still
+ *  using an evicted plan are not affected.  A capacity of zero
+ *  disables the cache.  The default capacity is 128.
+ *
+ *  Cached plans keep their device memory, such as twiddle tables,
+ *  allocated after every plan handle using them is destroyed.
+ *  ::hipfftExtPlanCacheClear and ::hipfftExtTrimMemory free the
+ *  plans no handle is using, whatever their place in the cache.
+ *
+ *  @param[in] capacity Maximum number of backend plans to keep.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanCacheSetCapacity(size_t capacity);
+
+/*! @brief Remove all plans from the plan cache.
+ *
+ *  @details Plan handles that are still using cached plans are not
+ *  affected.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanCacheClear();
+
+/*! @brief Get plan cache statistics.
+ *
+ *  @param[out] stats Hit, miss and eviction counts, and current size of the cache.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanCacheGetStats(hipfftExtPlanCacheStats* stats);
+
+/*! @brief Save the plans created so far to a wisdom file.
+ *
+ *  @details Records the parameters of the backend plans created by
+ *  this process, along with the work area size each needs, the GPU
+ *  architecture it was created for, and the backend's compiled
+ *  kernels.  Importing the file with ::hipfftExtImportWisdom in a
+ *  later process recreates those plans without compiling kernels
+ *  again.
+ *
+ *  Plans created on devices of the same architecture are recorded
+ *  once.  Only the 4096 most recently used plans are kept.
+ *
+ *  @param[in] path File to write.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtExportWisdom(const char* path);
+
+/*! @brief Load a wisdom file written by ::hipfftExtExportWisdom.
+ *
+ *  @details The backend's compiled kernels are loaded from the
+ *  file, and the backend plans it records are remembered for
+ *  devices of the architecture they were recorded on.  Plans for
+ *  architectures that none of the process's devices have are
+ *  skipped, since their work area sizes might not apply.  Plans made
+ *  later with the same parameters create their backend plans without
+ *  compiling kernels, and size queries such as ::hipfftGetSize1d
+ *  answer without creating them.  Remembered plans are exported
+ *  again by ::hipfftExtExportWisdom.
+ *
+ *  Returns ::HIPFFT_PARSE_ERROR without importing anything if the
+ *  file is corrupt, or was written by a different version of hipFFT
+ *  or the backend library.  Such files can simply be ignored.
+ *
+ *  @param[in] path File to read.
+ */
+HIPFFT_EXPORT hipfftResult hipfftExtImportWisdom(const char* path);
+
 /*! @brief Initialize a new one-dimensional FFT plan.
  *
  *  @details Assumes that the plan has been created already, and
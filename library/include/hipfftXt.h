@@ -222,6 +222,137 @@ HIPFFT_EXPORT hipfftResult hipfftXtGetSizeMany(hipfftHandle   plan,
                                                size_t*        workSize,
                                                hipDataType    executionType);
 
+/*! @brief Estimated device memory needed by a plan
+ *  @details See ::hipfftExtEstimateFootprint.  Sizes are in bytes.
+ *  */
+typedef struct hipfftExtFootprint_t
+{
+    /*! Work area size */
+    size_t work_buffer_bytes;
+    /*! Non-zero if the work area size is exact rather than estimated */
+    int work_buffer_exact;
+    /*! Twiddle tables, summed over all backend plans */
+    size_t twiddle_bytes;
+    /*! Other per-backend-plan state, summed over all backend plans */
+    size_t sub_plan_bytes;
+    /*! State for callbacks */
+    size_t callback_bytes;
+    /*! Number of backend plans the plan would create */
+    size_t num_sub_plans;
+    /*! Sum of all of the above sizes */
+    size_t total_bytes;
+} hipfftExtFootprint;
+
+/*! @brief Estimate the device memory a plan would need, without
+    creating it.
+
+ * @details Parameters are as for ::hipfftXtMakePlanMany.  If plan
+ * is not NULL, settings made on it (such as hints) are taken into
+ * account.  The plan itself is not modified.
+ *
+ * No backend plans are created and no kernels are compiled, so this
+ * is cheap enough to use for admission control.  Sizes are
+ * estimated from how the backend decomposes transforms, and are
+ * meant to be upper bounds.  The work area size is exact if the
+ * same backend plans have been created before in this process (or
+ * imported with ::hipfftExtImportWisdom).
+ *
+ *  @param[in] plan Pointer to the FFT plan, or NULL.
+ *  @param[in] rank Dimension of FFT transform (1, 2, or 3).
+ *  @param[in] n Number of elements in the x/y/z directions.
+ *  @param[in] inembed Number of elements in the input data in the x/y/z directions.
+ *  @param[in] istride Distance between two successive elements in the input data.
+ *  @param[in] idist Distance between input batches.
+ *  @param[in] inputType Format of FFT input.
+ *  @param[in] onembed Number of elements in the output data in the x/y/z directions.
+ *  @param[in] ostride Distance between two successive elements in the output data.
+ *  @param[in] odist Distance between output batches.
+ *  @param[in] outputType Format of FFT output.
+ *  @param[in] batch Number of batched transforms to perform.
+ *  @param[in] executionType Internal data format used by the library during computation.
+ *  @param[out] footprint Breakdown of the device memory needed.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtEstimateFootprint(hipfftHandle        plan,
+                                                      int                 rank,
+                                                      long long int*      n,
+                                                      long long int*      inembed,
+                                                      long long int       istride,
+                                                      long long int       idist,
+                                                      hipDataType         inputType,
+                                                      long long int*      onembed,
+                                                      long long int       ostride,
+                                                      long long int       odist,
+                                                      hipDataType         outputType,
+                                                      long long int       batch,
+                                                      hipDataType         executionType,
+                                                      hipfftExtFootprint* footprint);
+
+/*! @brief Begin creating a plan in the background, with
+    specified input, output, execution data types.
+
+ * @details Parameters are as for ::hipfftXtMakePlanMany, and are
+ * validated before returning.  The rocFFT plans are then created on
+ * an internal pool of worker threads, for the device that is
+ * current when this function is called.  The arrays passed in need
+ * not remain valid after this function returns.
+ *
+ * Use ::hipfftExtPlanWait or ::hipfftExtPlanQuery to find out
+ * when the plan is ready.  Executing the plan, querying its work
+ * area size or setting its work area or callbacks waits for plan
+ * creation to finish first.  An automatically-allocated work area is
+ * allocated by whichever of those calls finishes plan creation.
+ *
+ * Settings such as the scale factor must be set on the plan before
+ * calling this function to take effect.
+ *
+ *  @param[in] plan Pointer to the FFT plan.
+ *  @param[in] rank Dimension of FFT transform (1, 2, or 3).
+ *  @param[in] n Number of elements in the x/y/z directions.
+ *  @param[in] inembed Number of elements in the input data in the x/y/z directions.
+ *  @param[in] istride Distance between two successive elements in the input data.
+ *  @param[in] idist Distance between input batches.
+ *  @param[in] inputType Format of FFT input.
+ *  @param[in] onembed Number of elements in the output data in the x/y/z directions.
+ *  @param[in] ostride Distance between two successive elements in the output data.
+ *  @param[in] odist Distance between output batches.
+ *  @param[in] outputType Format of FFT output.
+ *  @param[in] batch Number of batched transforms to perform.
+ *  @param[in] executionType Internal data format used by the library during computation.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtMakePlanManyAsync(hipfftHandle   plan,
+                                                      int            rank,
+                                                      long long int* n,
+                                                      long long int* inembed,
+                                                      long long int  istride,
+                                                      long long int  idist,
+                                                      hipDataType    inputType,
+                                                      long long int* onembed,
+                                                      long long int  ostride,
+                                                      long long int  odist,
+                                                      hipDataType    outputType,
+                                                      long long int  batch,
+                                                      hipDataType    executionType);
+
+/*! @brief Wait for background plan creation to finish.
+
+ * @details Returns the result of creating the plan that was started
+ * by ::hipfftExtMakePlanManyAsync.  Returns `HIPFFT_SUCCESS` if no
+ * plan creation was started.
+ *
+ *  @param[in] plan Pointer to the FFT plan.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanWait(hipfftHandle plan);
+
+/*! @brief Check if background plan creation has finished.
+
+ * @details Returns `HIPFFT_PLAN_NOT_READY` without blocking if the
+ * plan started by ::hipfftExtMakePlanManyAsync is still being
+ * created.  Otherwise, behaves like ::hipfftExtPlanWait.
+ *
+ *  @param[in] plan Pointer to the FFT plan.
+ *  */
+HIPFFT_EXPORT hipfftResult hipfftExtPlanQuery(hipfftHandle plan);
+
 /*! @brief Execute an FFT plan for any precision and type.
 
  * @details An in-place transform is performed if the input and
@@ -22,8 +22,28 @@
 #include "hipfftXt.h"
 #include "rocfft/rocfft.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 #define ROC_FFT_CHECK_ALLOC_FAILED(ret)   \
@@ -49,27 +69,34 @@
         auto code = ret;              \
         if(code != HIPFFT_SUCCESS)    \
         {                             \
-            return ret;               \
+            return code;              \
         }                             \
     }
 
-// check plan creation - some might fail for specific placement, so
-// maintain a count of how many got created, and clean up the plans
-// if some failed.
-template <typename... Params>
-void ROC_FFT_CHECK_PLAN_CREATE(rocfft_plan& plan, unsigned int& plans_created, Params&&... params)
+// magic static to handle rocfft setup/cleanup.  Anything else that
+// is static and holds on to rocFFT objects needs to call this
+// before it's constructed, so that it's destroyed before rocFFT is
+// cleaned up.
+static void rocfft_init_once()
 {
-    if(rocfft_plan_create(&plan, std::forward<Params>(params)...) == rocfft_status_success)
-    {
-        ++plans_created;
-    }
-    else
+    struct rocfft_initializer
     {
-        rocfft_plan_destroy(plan);
-        plan = nullptr;
-    }
+        rocfft_initializer()
+        {
+            rocfft_setup();
+        }
+        ~rocfft_initializer()
+        {
+            rocfft_cleanup();
+        }
+    };
+    static rocfft_initializer init;
 }
 
+// rocfft_plans are reference-counted so that they can be shared
+// between hipFFT handles
+typedef std::shared_ptr<std::remove_pointer_t<rocfft_plan>> rocfft_plan_ptr;
+
 struct hipfftIOType
 {
     hipDataType inputType  = HIP_C_32F;
@@ -235,32 +262,6 @@ struct hipfftIOType
     }
 };
 
-struct hipfftHandle_t
-{
-    hipfftIOType type;
-
-    // Due to hipExec** compatibility to cuFFT, we have to reserve all 4 types
-    // rocfft handle separately here.
-    rocfft_plan           ip_forward          = nullptr;
-    rocfft_plan           op_forward          = nullptr;
-    rocfft_plan           ip_inverse          = nullptr;
-    rocfft_plan           op_inverse          = nullptr;
-    rocfft_execution_info info                = nullptr;
-    void*                 workBuffer          = nullptr;
-    size_t                workBufferSize      = 0;
-    bool                  autoAllocate        = true;
-    bool                  workBufferNeedsFree = false;
-
-    void** load_callback_ptrs       = nullptr;
-    void** load_callback_data       = nullptr;
-    size_t load_callback_lds_bytes  = 0;
-    void** store_callback_ptrs      = nullptr;
-    void** store_callback_data      = nullptr;
-    size_t store_callback_lds_bytes = 0;
-
-    double scale_factor = 1.0;
-};
-
 struct hipfft_plan_description_t
 {
     rocfft_array_type inArrayType, outArrayType;
@@ -281,455 +282,2489 @@ struct hipfft_plan_description_t
     }
 };
 
-hipfftResult hipfftPlan1d(hipfftHandle* plan, int nx, hipfftType type, int batch)
+// Everything that goes into creating a single rocfft_plan.  Sub-plans
+// with equal keys are interchangeable, so they can be shared between
+// hipFFT handles.
+struct hipfft_plan_key
 {
-    hipfftHandle handle = nullptr;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
-    *plan = handle;
-
-    return hipfftMakePlan1d(*plan, nx, type, batch, nullptr);
-}
+    int                     device               = 0;
+    rocfft_result_placement placement            = rocfft_placement_inplace;
+    rocfft_transform_type   transform_type       = rocfft_transform_type_complex_forward;
+    rocfft_precision        precision            = rocfft_precision_single;
+    size_t                  dim                  = 0;
+    std::array<size_t, 3>   lengths              = {0, 0, 0};
+    size_t                  number_of_transforms = 0;
+
+    // data layout is only given to rocFFT if the user specified one
+    bool                  has_layout   = false;
+    rocfft_array_type     inArrayType  = rocfft_array_type_complex_interleaved;
+    rocfft_array_type     outArrayType = rocfft_array_type_complex_interleaved;
+    std::array<size_t, 3> inStrides    = {0, 0, 0};
+    std::array<size_t, 3> outStrides   = {0, 0, 0};
+    size_t                inDist       = 0;
+    size_t                outDist      = 0;
 
-hipfftResult hipfftPlan2d(hipfftHandle* plan, int nx, int ny, hipfftType type)
-{
-    hipfftHandle handle = nullptr;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
-    *plan = handle;
+    double scale_factor = 1.0;
 
-    return hipfftMakePlan2d(*plan, nx, ny, type, nullptr);
-}
+    void set_layout(const hipfft_plan_description_t& desc,
+                    const size_t*                    i_strides,
+                    size_t                           i_dist,
+                    const size_t*                    o_strides,
+                    size_t                           o_dist)
+    {
+        has_layout   = true;
+        inArrayType  = desc.inArrayType;
+        outArrayType = desc.outArrayType;
+        std::copy_n(i_strides, 3, inStrides.begin());
+        std::copy_n(o_strides, 3, outStrides.begin());
+        inDist  = i_dist;
+        outDist = o_dist;
+    }
 
-hipfftResult hipfftPlan3d(hipfftHandle* plan, int nx, int ny, int nz, hipfftType type)
-{
-    hipfftHandle handle = nullptr;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
-    *plan = handle;
+    auto tie() const
+    {
+        return std::tie(device,
+                        placement,
+                        transform_type,
+                        precision,
+                        dim,
+                        lengths,
+                        number_of_transforms,
+                        has_layout,
+                        inArrayType,
+                        outArrayType,
+                        inStrides,
+                        outStrides,
+                        inDist,
+                        outDist,
+                        scale_factor);
+    }
 
-    return hipfftMakePlan3d(*plan, nx, ny, nz, type, nullptr);
-}
+    bool operator<(const hipfft_plan_key& other) const
+    {
+        return tie() < other.tie();
+    }
 
-hipfftResult hipfftPlanMany(hipfftHandle* plan,
-                            int           rank,
-                            int*          n,
-                            int*          inembed,
-                            int           istride,
-                            int           idist,
-                            int*          onembed,
-                            int           ostride,
-                            int           odist,
-                            hipfftType    type,
-                            int           batch)
-{
-    hipfftHandle handle = nullptr;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
-    *plan = handle;
+    // Size of one real value
+    size_t real_bytes() const
+    {
+        if(precision == rocfft_precision_double)
+            return sizeof(double);
+        if(precision == rocfft_precision_half)
+            return 2;
+        return sizeof(float);
+    }
 
-    return hipfftMakePlanMany(
-        *plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, nullptr);
-}
+    rocfft_array_type in_array_type() const
+    {
+        if(has_layout)
+            return inArrayType;
+        if(transform_type == rocfft_transform_type_real_forward)
+            return rocfft_array_type_real;
+        if(transform_type == rocfft_transform_type_real_inverse)
+            return rocfft_array_type_hermitian_interleaved;
+        return rocfft_array_type_complex_interleaved;
+    }
 
-hipfftResult hipfftPlanMany64(hipfftHandle*  plan,
-                              int            rank,
-                              long long int* n,
-                              long long int* inembed,
-                              long long int  istride,
-                              long long int  idist,
-                              long long int* onembed,
-                              long long int  ostride,
-                              long long int  odist,
-                              hipfftType     type,
-                              long long int  batch)
-{
-    hipfftHandle handle = nullptr;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
-    *plan = handle;
+    rocfft_array_type out_array_type() const
+    {
+        if(has_layout)
+            return outArrayType;
+        if(transform_type == rocfft_transform_type_real_forward)
+            return rocfft_array_type_hermitian_interleaved;
+        if(transform_type == rocfft_transform_type_real_inverse)
+            return rocfft_array_type_real;
+        return rocfft_array_type_complex_interleaved;
+    }
 
-    return hipfftMakePlanMany64(
-        *plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, nullptr);
-}
+    size_t element_bytes(rocfft_array_type type) const
+    {
+        return type == rocfft_array_type_real ? real_bytes() : 2 * real_bytes();
+    }
 
-hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
-                                     size_t                     dim,
-                                     size_t*                    lengths,
-                                     hipfftIOType               iotype,
-                                     size_t                     number_of_transforms,
-                                     hipfft_plan_description_t* desc,
-                                     size_t*                    workSize,
-                                     bool                       re_calc_strides_in_desc)
-{
-    // magic static to handle rocfft setup/cleanup
-    struct rocfft_initializer
+    // Byte distances between consecutive transforms in the input and
+    // output buffers
+    void batch_distances(size_t& in_bytes, size_t& out_bytes) const
     {
-        rocfft_initializer()
-        {
-            rocfft_setup();
-        }
-        ~rocfft_initializer()
+        const auto in_type  = in_array_type();
+        const auto out_type = out_array_type();
+
+        size_t in_dist  = inDist;
+        size_t out_dist = outDist;
+        if(!has_layout)
         {
-            rocfft_cleanup();
+            // rocFFT's default layouts are contiguous, with real data
+            // padded for in-place transforms
+            size_t outer = 1;
+            for(size_t i = 1; i < dim; ++i)
+                outer *= lengths[i];
+            const size_t complex_dist = (lengths[0] / 2 + 1) * outer;
+            const size_t real_dist    = placement == rocfft_placement_inplace
+                                            ? 2 * complex_dist
+                                            : lengths[0] * outer;
+            in_dist  = in_type == rocfft_array_type_real ? real_dist
+                       : in_type == rocfft_array_type_hermitian_interleaved ? complex_dist
+                                                                            : lengths[0] * outer;
+            out_dist = out_type == rocfft_array_type_real ? real_dist
+                       : out_type == rocfft_array_type_hermitian_interleaved ? complex_dist
+                                                                             : lengths[0] * outer;
         }
-    };
-    static rocfft_initializer init;
-
-    rocfft_plan_description ip_forward_desc = nullptr;
-    rocfft_plan_description op_forward_desc = nullptr;
-    rocfft_plan_description ip_inverse_desc = nullptr;
-    rocfft_plan_description op_inverse_desc = nullptr;
+        in_bytes  = in_dist * element_bytes(in_type);
+        out_bytes = out_dist * element_bytes(out_type);
+    }
 
-    if(desc != nullptr)
+    // Bytes spanned by the given number of transforms' input and
+    // output data
+    void buffer_bytes(size_t batch, size_t& in_bytes, size_t& out_bytes) const
     {
-        rocfft_plan_description_create(&ip_forward_desc);
-        rocfft_plan_description_create(&op_forward_desc);
-        rocfft_plan_description_create(&ip_inverse_desc);
-        rocfft_plan_description_create(&op_inverse_desc);
-
-        size_t i_strides[3] = {desc->inStrides[0], desc->inStrides[1], desc->inStrides[2]};
-        size_t o_strides[3] = {desc->outStrides[0], desc->outStrides[1], desc->outStrides[2]};
-
-        if(re_calc_strides_in_desc)
-        {
-            if(desc->inArrayType == rocfft_array_type_real) // real-to-complex
+        size_t in_dist = 0, out_dist = 0;
+        batch_distances(in_dist, out_dist);
+        in_bytes  = batch * in_dist;
+        out_bytes = batch * out_dist;
+        if(!has_layout || batch == 0)
+            return;
+
+        // strided data can reach past the last transform's distance
+        auto span = [&](rocfft_array_type type, const std::array<size_t, 3>& strides) {
+            size_t last = 0;
+            for(size_t i = 0; i < dim; ++i)
             {
-                size_t idist = 2 * (1 + lengths[0] / 2);
-                size_t odist = 1 + lengths[0] / 2;
-                for(size_t i = 1; i < dim; i++)
-                {
-                    i_strides[i] = idist;
-                    idist *= lengths[i];
-                    o_strides[i] = odist;
-                    odist *= lengths[i];
-                }
-
-                desc->inDist  = idist;
-                desc->outDist = odist;
-
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(ip_forward_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-
-                idist = lengths[0];
-                odist = 1 + lengths[0] / 2;
-                for(size_t i = 1; i < dim; i++)
-                {
-                    i_strides[i] = idist;
-                    idist *= lengths[i];
-                    o_strides[i] = odist;
-                    odist *= lengths[i];
-                }
-
-                desc->inDist  = idist;
-                desc->outDist = odist;
-
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(op_forward_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
+                const size_t len
+                    = i == 0 && type == rocfft_array_type_hermitian_interleaved
+                          ? lengths[0] / 2 + 1
+                          : lengths[i];
+                last += (len - 1) * strides[i];
             }
-            else if(desc->outArrayType == rocfft_array_type_real) // complex-to-real
-            {
-                size_t idist = 1 + lengths[0] / 2;
-                size_t odist = 2 * (1 + lengths[0] / 2);
-                for(size_t i = 1; i < dim; i++)
-                {
-                    i_strides[i] = idist;
-                    idist *= lengths[i];
-                    o_strides[i] = odist;
-                    odist *= lengths[i];
-                }
+            return (last + 1) * element_bytes(type);
+        };
+        in_bytes = std::max(in_bytes, (batch - 1) * in_dist + span(in_array_type(), inStrides));
+        out_bytes
+            = std::max(out_bytes, (batch - 1) * out_dist + span(out_array_type(), outStrides));
+    }
+};
 
-                desc->inDist  = idist;
-                desc->outDist = odist;
+// A rocfft_plan for one placement and direction, along with the key
+// needed to create it on demand
+struct hipfft_subplan
+{
+    hipfft_plan_key key;
+    rocfft_plan_ptr rplan;
+
+    // whether the key is meaningful for the plan's transform type
+    bool valid = false;
+    // whether we've already tried to create the rocfft_plan - it's
+    // legitimate for some placements to fail
+    bool attempted = false;
+    // time spent creating (or finding) the rocfft_plan
+    double build_seconds = 0.0;
+    // whether the work buffer size is known: the rocfft_plan was
+    // created, or for a size query, its size was found in the wisdom
+    bool sized = false;
+
+    // Number of transforms the caller asked for.  Under a memory
+    // limit this can be more than the key's number_of_transforms, in
+    // which case executions run the full batch in pieces, using the
+    // remainder plan for the last piece if it's smaller.
+    size_t          total_transforms = 0;
+    rocfft_plan_ptr remainder_rplan;
+};
 
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(ip_inverse_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
+static hipfftResult hipfftTrimIdleMemory();
 
-                idist = 1 + lengths[0] / 2;
-                odist = lengths[0];
-                for(size_t i = 1; i < dim; i++)
-                {
-                    i_strides[i] = idist;
-                    idist *= lengths[i];
-                    o_strides[i] = odist;
-                    odist *= lengths[i];
-                }
+// The application's memory pressure callback, if it registered one
+struct hipfft_memory_pressure
+{
+    std::mutex                      mutex;
+    hipfftExtMemoryPressureCallback callback  = nullptr;
+    void*                           user_data = nullptr;
+
+    static hipfft_memory_pressure& get()
+    {
+        static hipfft_memory_pressure pressure;
+        return pressure;
+    }
+};
 
-                desc->inDist  = idist;
-                desc->outDist = odist;
+// Allocate device memory, stream-ordered on the given stream if
+// async is set.  If the device is out of memory, free what the
+// library holds but isn't using and try again, and then let the
+// application's memory pressure callback free memory for as long as
+// it asks for another try, up to max_pressure_retries times.
+static const int max_pressure_retries = 8;
 
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(op_inverse_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-            }
-            else
-            {
+static hipError_t
+    hipfftDeviceMalloc(void** ptr, size_t size, hipStream_t stream = nullptr, bool async = false)
+{
+    auto alloc = [&]() {
+        const auto err = async ? hipMallocAsync(ptr, size, stream) : hipMalloc(ptr, size);
+        if(err != hipSuccess)
+        {
+            *ptr = nullptr;
+            (void)hipGetLastError();
+        }
+        return err;
+    };
 
-                size_t dist = lengths[0];
-                for(size_t i = 1; i < dim; i++)
-                {
-                    dist *= lengths[i];
-                }
+    auto err = alloc();
+    if(err == hipSuccess)
+        return err;
 
-                desc->inDist  = dist;
-                desc->outDist = dist;
+    hipfftTrimIdleMemory();
+    err = alloc();
 
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(ip_forward_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(op_forward_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(ip_inverse_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-                ROC_FFT_CHECK_INVALID_VALUE(
-                    rocfft_plan_description_set_data_layout(op_inverse_desc,
-                                                            desc->inArrayType,
-                                                            desc->outArrayType,
-                                                            0,
-                                                            0,
-                                                            dim,
-                                                            i_strides,
-                                                            desc->inDist,
-                                                            dim,
-                                                            o_strides,
-                                                            desc->outDist));
-            }
-        }
-        else
+    auto& pressure = hipfft_memory_pressure::get();
+    for(int retry = 0; err != hipSuccess && retry < max_pressure_retries; ++retry)
+    {
+        hipfftExtMemoryPressureCallback callback = nullptr;
+        void*                           user_data = nullptr;
         {
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(ip_forward_desc,
-                                                                                desc->inArrayType,
-                                                                                desc->outArrayType,
-                                                                                0,
-                                                                                0,
-                                                                                dim,
-                                                                                i_strides,
-                                                                                desc->inDist,
-                                                                                dim,
-                                                                                o_strides,
-                                                                                desc->outDist));
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(op_forward_desc,
-                                                                                desc->inArrayType,
-                                                                                desc->outArrayType,
-                                                                                0,
-                                                                                0,
-                                                                                dim,
-                                                                                i_strides,
-                                                                                desc->inDist,
-                                                                                dim,
-                                                                                o_strides,
-                                                                                desc->outDist));
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(ip_inverse_desc,
-                                                                                desc->inArrayType,
-                                                                                desc->outArrayType,
-                                                                                0,
-                                                                                0,
-                                                                                dim,
-                                                                                i_strides,
-                                                                                desc->inDist,
-                                                                                dim,
-                                                                                o_strides,
-                                                                                desc->outDist));
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_description_set_data_layout(op_inverse_desc,
-                                                                                desc->inArrayType,
-                                                                                desc->outArrayType,
-                                                                                0,
-                                                                                0,
-                                                                                dim,
-                                                                                i_strides,
-                                                                                desc->inDist,
-                                                                                dim,
-                                                                                o_strides,
-                                                                                desc->outDist));
-        }
-    }
-
-    if(plan->scale_factor != 1.0)
-    {
-        // scale factor requires a rocfft plan description, but
-        // rocfft plan descriptions might not have been created yet
-        if(!ip_forward_desc)
-            rocfft_plan_description_create(&ip_forward_desc);
-        if(!op_forward_desc)
-            rocfft_plan_description_create(&op_forward_desc);
-        if(!ip_inverse_desc)
-            rocfft_plan_description_create(&ip_inverse_desc);
-        if(!op_inverse_desc)
-            rocfft_plan_description_create(&op_inverse_desc);
-        for(auto rocfft_desc : {ip_forward_desc, op_forward_desc, ip_inverse_desc, op_inverse_desc})
-            rocfft_plan_description_set_scale_factor(rocfft_desc, plan->scale_factor);
+            std::lock_guard<std::mutex> lock(pressure.mutex);
+            callback  = pressure.callback;
+            user_data = pressure.user_data;
+        }
+        if(!callback || !callback(size, user_data))
+            break;
+        err = alloc();
     }
+    return err;
+}
 
-    // count the number of plans that got created - it's possible to
-    // have parameters that are valid for out-place but not for
-    // in-place, so some of these rocfft_plan_creates could
-    // legitimately fail.
-    unsigned int plans_created = 0;
-    for(auto t : iotype.transform_types())
+// Device buffers, streams and execution infos that a plan stages
+// host data through.  Each slot of the ring handles one chunk of the
+// batch at a time on its own stream, so that copies and transforms of
+// different chunks overlap.
+struct hipfft_host_staging
+{
+    struct slot
     {
-        // in-place
-        auto& ip_plan_ptr  = iotype.is_forward(t) ? plan->ip_forward : plan->ip_inverse;
-        auto& ip_plan_desc = iotype.is_forward(t) ? ip_forward_desc : ip_inverse_desc;
-        ROC_FFT_CHECK_PLAN_CREATE(ip_plan_ptr,
-                                  plans_created,
-                                  rocfft_placement_inplace,
-                                  t,
-                                  iotype.precision(),
-                                  dim,
-                                  lengths,
-                                  number_of_transforms,
-                                  ip_plan_desc);
-        // out-of-place
-        auto& op_plan_ptr  = iotype.is_forward(t) ? plan->op_forward : plan->op_inverse;
-        auto& op_plan_desc = iotype.is_forward(t) ? op_forward_desc : op_inverse_desc;
-        ROC_FFT_CHECK_PLAN_CREATE(op_plan_ptr,
-                                  plans_created,
-                                  rocfft_placement_notinplace,
-                                  t,
-                                  iotype.precision(),
-                                  dim,
-                                  lengths,
-                                  number_of_transforms,
-                                  op_plan_desc);
-    }
-
-    // if no plans got created, fail
-    if(plans_created == 0)
-        return HIPFFT_PARSE_ERROR;
-    plan->type = iotype;
+        hipStream_t           stream     = nullptr;
+        hipEvent_t            done       = nullptr;
+        rocfft_execution_info info       = nullptr;
+        void*                 in         = nullptr;
+        void*                 out        = nullptr;
+        void*                 work       = nullptr;
+        size_t                in_bytes   = 0;
+        size_t                out_bytes  = 0;
+        size_t                work_bytes = 0;
+    };
+    std::vector<slot> slots;
 
-    size_t workBufferSize = 0;
-    size_t tmpBufferSize  = 0;
+    // recorded on the plan's stream so the slots start after
+    // earlier work on it
+    hipEvent_t ready = nullptr;
 
-    bool const has_forward = !iotype.is_complex_to_real();
-    if(has_forward)
+    hipfft_host_staging()                           = default;
+    hipfft_host_staging(const hipfft_host_staging&) = delete;
+    hipfft_host_staging& operator=(const hipfft_host_staging&) = delete;
+
+    ~hipfft_host_staging()
     {
-        if(plan->ip_forward)
-        {
-            ROC_FFT_CHECK_INVALID_VALUE(
-                rocfft_plan_get_work_buffer_size(plan->ip_forward, &tmpBufferSize));
-            workBufferSize = std::max(workBufferSize, tmpBufferSize);
-        }
-        if(plan->op_forward)
+        for(auto& s : slots)
         {
-            ROC_FFT_CHECK_INVALID_VALUE(
-                rocfft_plan_get_work_buffer_size(plan->op_forward, &tmpBufferSize));
-            workBufferSize = std::max(workBufferSize, tmpBufferSize);
+            if(s.stream)
+                hipStreamSynchronize(s.stream);
+            for(auto ptr : {s.in, s.out, s.work})
+                if(ptr)
+                    hipFree(ptr);
+            if(s.info)
+                rocfft_execution_info_destroy(s.info);
+            if(s.done)
+                hipEventDestroy(s.done);
+            if(s.stream)
+                hipStreamDestroy(s.stream);
         }
+        if(ready)
+            hipEventDestroy(ready);
     }
 
-    bool const has_inverse = !iotype.is_real_to_complex();
-    if(has_inverse)
+    // Make sure there are this many slots, with buffers at least
+    // the given sizes
+    hipfftResult
+        prepare(size_t depth, size_t in_size, size_t out_size, size_t work_size, bool inplace)
     {
-        if(plan->ip_inverse)
-        {
-            ROC_FFT_CHECK_INVALID_VALUE(
-                rocfft_plan_get_work_buffer_size(plan->ip_inverse, &tmpBufferSize));
-            workBufferSize = std::max(workBufferSize, tmpBufferSize);
-        }
-        if(plan->op_inverse)
+        if(!ready && hipEventCreateWithFlags(&ready, hipEventDisableTiming) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        slots.resize(std::max(slots.size(), depth));
+        for(auto& s : slots)
         {
-            ROC_FFT_CHECK_INVALID_VALUE(
-                rocfft_plan_get_work_buffer_size(plan->op_inverse, &tmpBufferSize));
-            workBufferSize = std::max(workBufferSize, tmpBufferSize);
+            if(!s.stream && hipStreamCreateWithFlags(&s.stream, hipStreamNonBlocking) != hipSuccess)
+                return HIPFFT_ALLOC_FAILED;
+            if(!s.done && hipEventCreateWithFlags(&s.done, hipEventDisableTiming) != hipSuccess)
+                return HIPFFT_ALLOC_FAILED;
+            if(!s.info)
+            {
+                ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_create(&s.info));
+                ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_stream(s.info, s.stream));
+            }
+            HIP_FFT_CHECK_AND_RETURN(
+                grow(s, s.in, s.in_bytes, inplace ? std::max(in_size, out_size) : in_size));
+            if(!inplace)
+                HIP_FFT_CHECK_AND_RETURN(grow(s, s.out, s.out_bytes, out_size));
+            const auto old_work = s.work;
+            HIP_FFT_CHECK_AND_RETURN(grow(s, s.work, s.work_bytes, work_size));
+            if(s.work != old_work)
+                ROC_FFT_CHECK_INVALID_VALUE(
+                    rocfft_execution_info_set_work_buffer(s.info, s.work, s.work_bytes));
         }
+        return HIPFFT_SUCCESS;
     }
 
-    if(workBufferSize > 0)
+private:
+    // buffers might still be in use by an earlier execution, so wait
+    // for that before replacing them
+    static hipfftResult grow(slot& s, void*& ptr, size_t& bytes, size_t size)
     {
-        if(plan->autoAllocate)
+        if(size <= bytes)
+            return HIPFFT_SUCCESS;
+        if(ptr)
         {
-            if(plan->workBuffer && plan->workBufferNeedsFree)
-                if(hipFree(plan->workBuffer) != hipSuccess)
-                    return HIPFFT_ALLOC_FAILED;
-            if(hipMalloc(&plan->workBuffer, workBufferSize) != hipSuccess)
+            if(hipStreamSynchronize(s.stream) != hipSuccess || hipFree(ptr) != hipSuccess)
                 return HIPFFT_ALLOC_FAILED;
-            plan->workBufferNeedsFree = true;
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_work_buffer(
-                plan->info, plan->workBuffer, workBufferSize));
+            ptr   = nullptr;
+            bytes = 0;
         }
+        if(hipfftDeviceMalloc(&ptr, size) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        bytes = size;
+        return HIPFFT_SUCCESS;
     }
+};
 
-    if(workSize != nullptr)
-        *workSize = workBufferSize;
+// Streams that a plan's executions split their batch across.  Each
+// partition of the batch runs on its own stream, with its own
+// execution info and slice of the plan's work area.  The first
+// stream is the plan's own.
+struct hipfft_stream_set
+{
+    struct partition
+    {
+        hipStream_t           stream = nullptr;
+        rocfft_execution_info info   = nullptr;
+        hipEvent_t            done   = nullptr;
+    };
+    std::vector<partition> parts;
 
-    plan->workBufferSize = workBufferSize;
+    // recorded on the plan's stream so the other partitions start
+    // after earlier work on it
+    hipEvent_t start = nullptr;
 
-    rocfft_plan_description_destroy(ip_forward_desc);
-    rocfft_plan_description_destroy(op_forward_desc);
-    rocfft_plan_description_destroy(ip_inverse_desc);
-    rocfft_plan_description_destroy(op_inverse_desc);
+    // the work area the slices were last carved from
+    void*  work       = nullptr;
+    size_t slice_size = 0;
 
-    return HIPFFT_SUCCESS;
-}
+    hipfft_stream_set()                         = default;
+    hipfft_stream_set(const hipfft_stream_set&) = delete;
+    hipfft_stream_set& operator=(const hipfft_stream_set&) = delete;
 
-hipfftResult hipfftCreate(hipfftHandle* plan)
-{
-    // NOTE: cufft backend uses int for handle type, so this wouldn't
-    // work using cufft types.  This is the rocfft backend, but
+    ~hipfft_stream_set()
+    {
+        for(auto& p : parts)
+        {
+            if(p.info)
+                rocfft_execution_info_destroy(p.info);
+            if(p.done)
+                hipEventDestroy(p.done);
+        }
+        if(start)
+            hipEventDestroy(start);
+    }
+
+    hipfftResult init(int count, const hipStream_t streams[])
+    {
+        if(hipEventCreateWithFlags(&start, hipEventDisableTiming) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        parts.resize(count);
+        for(int i = 0; i < count; ++i)
+        {
+            auto& p  = parts[i];
+            p.stream = streams[i];
+            if(hipEventCreateWithFlags(&p.done, hipEventDisableTiming) != hipSuccess)
+                return HIPFFT_ALLOC_FAILED;
+            ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_create(&p.info));
+            ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_stream(p.info, p.stream));
+        }
+        return HIPFFT_SUCCESS;
+    }
+
+    // Give each partition a slice of the given size of a work area
+    // that's big enough for all of them
+    hipfftResult use_work(void* area, size_t size)
+    {
+        if(area == work && size == slice_size)
+            return HIPFFT_SUCCESS;
+        work       = area;
+        slice_size = size;
+        for(size_t i = 0; i < parts.size(); ++i)
+            ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_work_buffer(
+                parts[i].info, static_cast<char*>(work) + i * size, size));
+        return HIPFFT_SUCCESS;
+    }
+};
+
+// One pass of an out-of-core transform.  The data is viewed as a
+// number of independent lines that are each transformed the same
+// way, and moved through the device a chunk of lines at a time.  On
+// the host, a chunk of lines is a 2D region on each side: `rows` rows
+// of `line_bytes` per line, `pitch` bytes apart.
+struct hipfft_ooc_pass
+{
+    struct side
+    {
+        size_t rows       = 1;
+        size_t line_bytes = 0;
+        size_t pitch      = 0;
+        // on the device, lines are either interleaved element by
+        // element (columns), or stored one after the other
+        bool columns = false;
+    };
+    side in;
+    side out;
+
+    size_t                dim     = 1;
+    std::array<size_t, 3> lengths = {0, 0, 0};
+    double                scale   = 1.0;
+
+    size_t lines = 0;
+    size_t chunk = 0;
+
+    // whether four-step twiddles are applied to this pass's output
+    bool twiddle = false;
+
+    // rocFFT plans for a full chunk and for the last, smaller one,
+    // for forward and backward transforms
+    rocfft_plan_ptr plans[2][2];
+    size_t          work_bytes = 0;
+
+    // Key for the plan transforming `count` lines on the device
+    hipfft_plan_key key(int device, rocfft_precision precision, bool forward, size_t count) const
+    {
+        hipfft_plan_key key;
+        key.device               = device;
+        key.placement            = rocfft_placement_notinplace;
+        key.transform_type       = forward ? rocfft_transform_type_complex_forward
+                                           : rocfft_transform_type_complex_inverse;
+        key.precision            = precision;
+        key.dim                  = dim;
+        key.lengths              = lengths;
+        key.number_of_transforms = count;
+        key.has_layout           = true;
+        key.scale_factor         = scale;
+        auto layout = [&](const side& s, std::array<size_t, 3>& strides, size_t& dist) {
+            if(s.columns)
+            {
+                strides = {count, 0, 0};
+                dist    = 1;
+                return;
+            }
+            dist = 1;
+            for(size_t i = 0; i < dim; ++i)
+            {
+                strides[i] = dist;
+                dist *= lengths[i];
+            }
+        };
+        layout(in, key.inStrides, key.inDist);
+        layout(out, key.outStrides, key.outDist);
+        return key;
+    }
+};
+
+// A transform too big for device memory, done in passes over data
+// in host memory.  1D transforms use the four-step algorithm, with
+// twiddles applied on the host between the passes; 2D and 3D
+// transforms transform slabs of the fastest dimensions and then
+// pencils of the slowest one.
+struct hipfft_ooc_transform
+{
+    std::vector<hipfft_ooc_pass> passes;
+    rocfft_precision             precision = rocfft_precision_single;
+    size_t                       elements  = 0;
+    size_t                       batch     = 0;
+
+    // four-step factors for 1D transforms, and forward twiddles
+    // W_N^r and W_N^(q*n1) that multiply to give any W_N^e
+    size_t                            n1 = 0;
+    size_t                            n2 = 0;
+    std::vector<std::complex<double>> twiddle_lo;
+    std::vector<std::complex<double>> twiddle_hi;
+
+    // device buffer sizes each staging slot needs
+    size_t slot_in_bytes   = 0;
+    size_t slot_out_bytes  = 0;
+    size_t slot_work_bytes = 0;
+
+    size_t element_bytes() const
+    {
+        return precision == rocfft_precision_double ? 2 * sizeof(double) : 2 * sizeof(float);
+    }
+};
+
+struct hipfft_host_deleter
+{
+    void operator()(void* ptr) const
+    {
+        hipHostFree(ptr);
+    }
+};
+
+// Executions of a plan captured into graphs by hipfftExtExecGraph,
+// and the stream they're captured on
+struct hipfft_graph_cache
+{
+    struct entry
+    {
+        // everything the captured launches depend on.  The rocfft_plans
+        // are held so that their addresses can't be reused.
+        rocfft_plan_ptr rplan;
+        rocfft_plan_ptr remainder_rplan;
+        void*           idata        = nullptr;
+        void*           odata        = nullptr;
+        void*           work         = nullptr;
+        void**          callbacks[4] = {};
+        hipGraphExec_t  exec         = nullptr;
+
+        // a split execution's partitions use the stream set's events,
+        // infos and work buffer
+        const void* stream_set = nullptr;
+        void*       set_work   = nullptr;
+
+        bool matches(const entry& other) const
+        {
+            return rplan == other.rplan && remainder_rplan == other.remainder_rplan
+                   && idata == other.idata && odata == other.odata && work == other.work
+                   && std::equal(callbacks, callbacks + 4, other.callbacks)
+                   && stream_set == other.stream_set && set_work == other.set_work;
+        }
+    };
+
+    static constexpr size_t capacity = 8;
+
+    hipStream_t      stream = nullptr;
+    std::list<entry> entries;
+
+    hipfft_graph_cache() = default;
+    ~hipfft_graph_cache()
+    {
+        for(auto& e : entries)
+            hipGraphExecDestroy(e.exec);
+        if(stream)
+            hipStreamDestroy(stream);
+    }
+    hipfft_graph_cache(const hipfft_graph_cache&) = delete;
+    hipfft_graph_cache& operator=(const hipfft_graph_cache&) = delete;
+};
+
+struct hipfftHandle_t
+{
+    hipfftIOType type;
+
+    // Due to hipExec** compatibility to cuFFT, we have to reserve all 4 types
+    // rocfft handle separately here.
+    hipfft_subplan        ip_forward;
+    hipfft_subplan        op_forward;
+    hipfft_subplan        ip_inverse;
+    hipfft_subplan        op_inverse;
+    rocfft_execution_info info                = nullptr;
+    void*                 workBuffer          = nullptr;
+    size_t                workBufferSize      = 0;
+    size_t                workBufferAllocSize = 0;
+    bool                  autoAllocate        = true;
+    bool                  workBufferNeedsFree = false;
+    int                   workBufferMode      = HIPFFT_EXT_WORKBUFFER_EAGER;
+    hipStream_t           stream              = nullptr;
+
+    // stream the work buffer was allocated on, if it was allocated
+    // stream-ordered
+    bool        workBufferAsync  = false;
+    hipStream_t workBufferStream = nullptr;
+
+    // group whose work buffer this plan shares, if any
+    hipfftExtWorkAreaGroup work_area_group = nullptr;
+
+    // whether the execution info was ever given a work buffer
+    bool info_has_work_buffer = false;
+
+    // managed memory prefetching, and how much of it has been done
+    bool   prefetch_managed = false;
+    size_t prefetch_bytes   = 0;
+    size_t prefetches       = 0;
+
+    // executions on host memory are staged through this many device
+    // buffers, in chunks of this many transforms (0 to choose)
+    int                                  staging_depth  = 0;
+    size_t                               staging_chunk  = 0;
+    std::unique_ptr<hipfft_host_staging> staging;
+
+    // out-of-core transforms, and the host scratch buffer in-place
+    // 1D ones need
+    bool                                        out_of_core = false;
+    std::shared_ptr<const hipfft_ooc_transform> ooc;
+    std::unique_ptr<void, hipfft_host_deleter>  ooc_scratch;
+    size_t                                      ooc_scratch_bytes = 0;
+
+    // largest work buffer the plan may use, or 0 for no limit
+    size_t memory_limit = 0;
+
+    // graphs captured by hipfftExtExecGraph
+    std::unique_ptr<hipfft_graph_cache> graphs;
+
+    // streams to split executions' batches across, if more than one
+    // was set
+    std::unique_ptr<hipfft_stream_set> stream_set;
+
+    // sub-plans for hipfftExtExecBatch executions of part of the
+    // batch, most recently used first
+    std::list<hipfft_subplan> batch_subplans;
+
+    // held while the plan executes or replaces its work buffer, so
+    // that trimming idle memory leaves the plan alone meanwhile.  See
+    // hipfft_plan_lock.
+    std::mutex buffer_mutex;
+
+    // neighbours in the list of live handles
+    hipfftHandle_t* prev_live = nullptr;
+    hipfftHandle_t* next_live = nullptr;
+
+    void** load_callback_ptrs       = nullptr;
+    void** load_callback_data       = nullptr;
+    size_t load_callback_lds_bytes  = 0;
+    void** store_callback_ptrs      = nullptr;
+    void** store_callback_data      = nullptr;
+    size_t store_callback_lds_bytes = 0;
+
+    double scale_factor = 1.0;
+    // other scale factors that hipfftExtExecScaled may execute with,
+    // and the sub-plans for each of them, in the same order as
+    // ip_forward, op_forward, ip_inverse and op_inverse.  Created with
+    // the plan and kept until it's re-planned or destroyed, so that
+    // executions never wait for a plan or free one that's running.
+    std::vector<double>                             dynamic_scales;
+    std::map<double, std::array<hipfft_subplan, 4>> scaled_subplans;
+
+    // create sub-plans on first use, instead of all up front
+    bool lazy_plans = false;
+    // create sub-plans in parallel on the thread pool
+    bool concurrent_build = false;
+    // only work out the work buffer size, see hipfftInitSizeQuery
+    bool size_query = false;
+    // wall-clock time spent creating sub-plans
+    double build_seconds = 0.0;
+
+    // placements and directions the plan will be executed with
+    int placement_hints = HIPFFT_EXT_PLACEMENT_ALL;
+    int direction_hints = HIPFFT_EXT_DIRECTION_ALL;
+
+    // plan creation running in the background, see
+    // hipfftExtMakePlanManyAsync.  The worker builds into a separate
+    // staging handle, which is moved into this one once the caller
+    // waits for it.
+    std::future<hipfftResult>       pending_plan;
+    std::shared_ptr<hipfftHandle_t> pending_staged;
+    hipfftResult                    pending_status = HIPFFT_SUCCESS;
+};
+
+// Holds a plan's buffer_mutex, and remembers that the current thread
+// holds it.  Memory freed under memory pressure must skip those
+// plans, since the thread that's out of memory may be in the middle
+// of changing them.
+class hipfft_plan_lock
+{
+public:
+    explicit hipfft_plan_lock(hipfftHandle plan)
+        : plan(plan)
+    {
+        plan->buffer_mutex.lock();
+        held().push_back(plan);
+    }
+
+    ~hipfft_plan_lock()
+    {
+        auto& plans = held();
+        plans.erase(std::find(plans.begin(), plans.end(), plan));
+        plan->buffer_mutex.unlock();
+    }
+
+    hipfft_plan_lock(const hipfft_plan_lock&) = delete;
+    hipfft_plan_lock& operator=(const hipfft_plan_lock&) = delete;
+
+    static bool held_by_this_thread(hipfftHandle plan)
+    {
+        const auto& plans = held();
+        return std::find(plans.begin(), plans.end(), plan) != plans.end();
+    }
+
+private:
+    static std::vector<hipfftHandle>& held()
+    {
+        thread_local std::vector<hipfftHandle> plans;
+        return plans;
+    }
+
+    hipfftHandle plan;
+};
+
+// Plans sharing one work buffer, sized for the most demanding of
+// them
+struct hipfftExtWorkAreaGroup_t
+{
+    std::vector<hipfftHandle> plans;
+    void*                     buffer = nullptr;
+    size_t                    size   = 0;
+};
+
+static void hipfftRecordWisdom(const hipfft_plan_key& key, size_t workBufferSize);
+
+// Create a rocfft_plan for the given key.  Returns an error if the
+// key itself is malformed.  Otherwise, success is returned but the
+// plan is left null if rocFFT could not create it - this is
+// expected for some placements of otherwise valid transforms.
+static hipfftResult hipfftCreateRocfftPlan(const hipfft_plan_key& key, rocfft_plan_ptr& rplan)
+{
+    rplan.reset();
+
+    // scale factor and data layout require a rocfft plan description
+    rocfft_plan_description rocfft_desc = nullptr;
+    if(key.has_layout || key.scale_factor != 1.0)
+    {
+        ROC_FFT_CHECK_ALLOC_FAILED(rocfft_plan_description_create(&rocfft_desc));
+        if(key.has_layout
+           && rocfft_plan_description_set_data_layout(rocfft_desc,
+                                                      key.inArrayType,
+                                                      key.outArrayType,
+                                                      0,
+                                                      0,
+                                                      key.dim,
+                                                      key.inStrides.data(),
+                                                      key.inDist,
+                                                      key.dim,
+                                                      key.outStrides.data(),
+                                                      key.outDist)
+                  != rocfft_status_success)
+        {
+            rocfft_plan_description_destroy(rocfft_desc);
+            return HIPFFT_INVALID_VALUE;
+        }
+        if(key.scale_factor != 1.0)
+            rocfft_plan_description_set_scale_factor(rocfft_desc, key.scale_factor);
+    }
+
+    rocfft_plan p = nullptr;
+    if(rocfft_plan_create(&p,
+                          key.placement,
+                          key.transform_type,
+                          key.precision,
+                          key.dim,
+                          key.lengths.data(),
+                          key.number_of_transforms,
+                          rocfft_desc)
+       == rocfft_status_success)
+    {
+        rplan = rocfft_plan_ptr(p, rocfft_plan_destroy);
+
+        // every plan created is remembered for hipfftExtExportWisdom
+        size_t workBufferSize = 0;
+        if(rocfft_plan_get_work_buffer_size(p, &workBufferSize) == rocfft_status_success)
+            hipfftRecordWisdom(key, workBufferSize);
+    }
+    else
+    {
+        rocfft_plan_destroy(p);
+    }
+
+    rocfft_plan_description_destroy(rocfft_desc);
+    return HIPFFT_SUCCESS;
+}
+
+// Process-wide cache of rocfft_plans.  rocfft_plans are immutable
+// once created, so any number of handles can execute the same one,
+// each with its own rocfft_execution_info.
+//
+// The cache holds a reference to each plan in it, so plans stay
+// alive after the last handle using them is destroyed.  Once there
+// are more plans than the capacity allows, the least recently used
+// ones are evicted.  Handles still using an evicted plan keep it
+// alive until they are destroyed.
+class hipfft_plan_cache
+{
+public:
+    static hipfft_plan_cache& get()
+    {
+        rocfft_init_once();
+        static hipfft_plan_cache cache;
+        return cache;
+    }
+
+    // Return a plan matching the key, creating it if it's not
+    // already in the cache.
+    hipfftResult find_or_create(const hipfft_plan_key& key, rocfft_plan_ptr& rplan)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto                        it = index.find(key);
+            if(it != index.end())
+            {
+                ++hits;
+                lru.splice(lru.begin(), lru, it->second);
+                rplan = it->second->second;
+                return HIPFFT_SUCCESS;
+            }
+            ++misses;
+        }
+
+        // plan creation can be slow, so don't hold the lock while
+        // doing it
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateRocfftPlan(key, rplan));
+        if(!rplan)
+            return HIPFFT_SUCCESS;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(capacity == 0)
+            return HIPFFT_SUCCESS;
+
+        // another thread might have created the same plan in the
+        // meantime - prefer the one that's already cached
+        auto it = index.find(key);
+        if(it != index.end())
+        {
+            lru.splice(lru.begin(), lru, it->second);
+            rplan = it->second->second;
+            return HIPFFT_SUCCESS;
+        }
+        lru.emplace_front(key, rplan);
+        index.emplace(key, lru.begin());
+        evict();
+        return HIPFFT_SUCCESS;
+    }
+
+    void set_capacity(size_t new_capacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = new_capacity;
+        evict();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        evictions += lru.size();
+        index.clear();
+        lru.clear();
+    }
+
+    // Evict the plans that no handle is using
+    void trim()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto it = lru.begin(); it != lru.end();)
+        {
+            if(it->second.use_count() > 1)
+            {
+                ++it;
+                continue;
+            }
+            index.erase(it->first);
+            it = lru.erase(it);
+            ++evictions;
+        }
+    }
+
+    void get_stats(hipfftExtPlanCacheStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.hits      = hits;
+        stats.misses    = misses;
+        stats.evictions = evictions;
+        stats.entries   = lru.size();
+        stats.capacity  = capacity;
+    }
+
+private:
+    hipfft_plan_cache() = default;
+
+    // drop least recently used plans until we're within capacity.
+    // caller must hold the mutex.
+    void evict()
+    {
+        while(lru.size() > capacity)
+        {
+            index.erase(lru.back().first);
+            lru.pop_back();
+            ++evictions;
+        }
+    }
+
+    std::mutex mutex;
+    // most recently used plans are at the front
+    std::list<std::pair<hipfft_plan_key, rocfft_plan_ptr>>           lru;
+    std::map<hipfft_plan_key, decltype(lru)::iterator> index;
+
+    size_t capacity  = 128;
+    size_t hits      = 0;
+    size_t misses    = 0;
+    size_t evictions = 0;
+};
+
+// Pool of worker threads that create plans in the background.
+//
+// Queued tasks are still run when the pool is destroyed at process
+// exit.  They use the plan cache, so the cache is constructed
+// before the pool to ensure it's destroyed after it.
+class hipfft_thread_pool
+{
+public:
+    static hipfft_thread_pool& get()
+    {
+        hipfft_plan_cache::get();
+        static hipfft_thread_pool pool;
+        return pool;
+    }
+
+    template <typename F>
+    std::future<hipfftResult> submit(F&& f)
+    {
+        auto task   = std::make_shared<std::packaged_task<hipfftResult()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([task]() { (*task)(); });
+        }
+        cv.notify_one();
+        return future;
+    }
+
+    ~hipfft_thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for(auto& w : workers)
+            w.join();
+    }
+
+private:
+    hipfft_thread_pool()
+    {
+        // rocFFT kernel compilation is itself multithreaded, so a few
+        // workers are enough to keep several plans in flight
+        const size_t num_workers
+            = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), 4);
+        for(size_t i = 0; i < num_workers; ++i)
+            workers.emplace_back([this]() { run(); });
+    }
+
+    void run()
+    {
+        for(;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if(tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex                        mutex;
+    std::condition_variable           cv;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread>          workers;
+    bool                              stopping = false;
+};
+
+// Record of the rocfft_plans created in this process, and their work
+// buffer sizes, for hipfftExtExportWisdom.  Plans are recorded for
+// the GPU architecture they were created on rather than the device,
+// so that identical devices share entries.  Once there are more
+// entries than the capacity allows, the least recently used ones are
+// forgotten.
+//
+// Wisdom files are laid out as:
+//
+//   magic, format version, hipFFT version, rocFFT version string,
+//   number of plans, plans, rocFFT kernel cache, checksum
+//
+// where each plan is its architecture name, its key without the
+// device, and its work buffer size.  Everything is written as
+// native-endian 64-bit integers, strings and blobs being prefixed
+// with their length.  The checksum is a 64-bit FNV-1a hash of
+// everything before it.
+class hipfft_wisdom
+{
+public:
+    static constexpr size_t capacity = 4096;
+
+    // A recorded plan: its device's architecture, and its key with
+    // the device left out
+    using entry_key = std::pair<std::string, hipfft_plan_key>;
+
+    static hipfft_wisdom& get()
+    {
+        static hipfft_wisdom wisdom;
+        return wisdom;
+    }
+
+    void record(const hipfft_plan_key& key, size_t workBufferSize)
+    {
+        std::string arch;
+        if(!device_arch(key.device, arch))
+            return;
+        record(entry_key(arch, without_device(key)), workBufferSize);
+    }
+
+    void record(const entry_key& key, size_t workBufferSize)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        it = index.find(key);
+        if(it != index.end())
+        {
+            it->second->second = workBufferSize;
+            lru.splice(lru.begin(), lru, it->second);
+            return;
+        }
+        lru.emplace_front(key, workBufferSize);
+        index.emplace(key, lru.begin());
+        if(lru.size() > capacity)
+        {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+
+    // Look up the work buffer size of a plan created before
+    bool lookup(const hipfft_plan_key& key, size_t& workBufferSize)
+    {
+        std::string arch;
+        if(!device_arch(key.device, arch))
+            return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(entry_key(arch, without_device(key)));
+        if(it == index.end())
+            return false;
+        lru.splice(lru.begin(), lru, it->second);
+        workBufferSize = it->second->second;
+        return true;
+    }
+
+    // Architecture name of a device, as recorded in wisdom files
+    bool device_arch(int device, std::string& arch)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        it = archs.find(device);
+        if(it == archs.end())
+        {
+            hipDeviceProp_t prop;
+            if(hipGetDeviceProperties(&prop, device) != hipSuccess)
+                return false;
+            it = archs.emplace(device, std::string(prop.gcnArchName)).first;
+        }
+        arch = it->second;
+        return true;
+    }
+
+    // Serialize the recorded plans and the kernel cache.
+    hipfftResult serialize(std::string& out)
+    {
+        out.clear();
+        out.append(magic, sizeof(magic));
+        put(out, format_version);
+        put(out, library_version());
+        put(out, rocfft_version());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            put(out, lru.size());
+            for(const auto& p : lru)
+            {
+                put(out, p.first.first);
+                put_key(out, p.first.second);
+                put(out, p.second);
+            }
+        }
+
+        void*  kernels     = nullptr;
+        size_t kernels_len = 0;
+        ROC_FFT_CHECK_ALLOC_FAILED(rocfft_cache_serialize(&kernels, &kernels_len));
+        put(out, std::string(static_cast<const char*>(kernels), kernels_len));
+        rocfft_cache_buffer_free(kernels);
+
+        put(out, checksum(out.data(), out.size()));
+        return HIPFFT_SUCCESS;
+    }
+
+    // Check and parse serialized wisdom.  Files written by another
+    // version of hipFFT or rocFFT are rejected, as are corrupt ones.
+    static hipfftResult deserialize(const std::string&                          in,
+                                    std::vector<std::pair<entry_key, size_t>>& keys,
+                                    std::string&                                kernels)
+    {
+        if(in.size() < sizeof(magic) + sizeof(uint64_t))
+            return HIPFFT_PARSE_ERROR;
+        const size_t body_len = in.size() - sizeof(uint64_t);
+        reader       checksum_reader{in.data() + body_len, in.data() + in.size()};
+        uint64_t     stored_checksum = 0;
+        if(!checksum_reader.get(stored_checksum)
+           || stored_checksum != checksum(in.data(), body_len))
+            return HIPFFT_PARSE_ERROR;
+
+        if(!std::equal(magic, magic + sizeof(magic), in.data()))
+            return HIPFFT_PARSE_ERROR;
+        reader      r{in.data() + sizeof(magic), in.data() + body_len};
+        uint64_t    version = 0, library = 0, num_plans = 0;
+        std::string rocfft;
+        if(!r.get(version) || version != format_version || !r.get(library)
+           || library != library_version() || !r.get(rocfft) || rocfft != rocfft_version()
+           || !r.get(num_plans))
+            return HIPFFT_PARSE_ERROR;
+
+        keys.clear();
+        for(uint64_t i = 0; i < num_plans; ++i)
+        {
+            entry_key key;
+            uint64_t  workBufferSize = 0;
+            if(!r.get(key.first) || !get_key(r, key.second) || !r.get(workBufferSize))
+                return HIPFFT_PARSE_ERROR;
+            keys.emplace_back(key, workBufferSize);
+        }
+        if(!r.get(kernels) || r.pos != r.end)
+            return HIPFFT_PARSE_ERROR;
+        return HIPFFT_SUCCESS;
+    }
+
+private:
+    hipfft_wisdom() = default;
+
+    static constexpr char     magic[8]       = {'H', 'I', 'P', 'F', 'F', 'T', 'W', 'S'};
+    static constexpr uint64_t format_version = 2;
+
+    static hipfft_plan_key without_device(hipfft_plan_key key)
+    {
+        key.device = 0;
+        return key;
+    }
+
+    static uint64_t library_version()
+    {
+        return hipfftVersionMajor * 10000 + hipfftVersionMinor * 100 + hipfftVersionPatch;
+    }
+
+    static std::string rocfft_version()
+    {
+        char v[256] = {};
+        rocfft_get_version_string(v, sizeof(v));
+        return v;
+    }
+
+    static uint64_t checksum(const char* data, size_t len)
+    {
+        uint64_t hash = 0xcbf29ce484222325;
+        for(size_t i = 0; i < len; ++i)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+    static void put(std::string& out, uint64_t val)
+    {
+        out.append(reinterpret_cast<const char*>(&val), sizeof(val));
+    }
+
+    static void put(std::string& out, const std::string& str)
+    {
+        put(out, str.size());
+        out.append(str);
+    }
+
+    struct reader
+    {
+        const char* pos;
+        const char* end;
+
+        bool get(uint64_t& val)
+        {
+            if(static_cast<size_t>(end - pos) < sizeof(val))
+                return false;
+            std::copy_n(pos, sizeof(val), reinterpret_cast<char*>(&val));
+            pos += sizeof(val);
+            return true;
+        }
+
+        bool get(std::string& str)
+        {
+            uint64_t len = 0;
+            if(!get(len) || static_cast<uint64_t>(end - pos) < len)
+                return false;
+            str.assign(pos, len);
+            pos += len;
+            return true;
+        }
+    };
+
+    static void put_key(std::string& out, const hipfft_plan_key& key)
+    {
+        uint64_t scale_bits = 0;
+        std::copy_n(reinterpret_cast<const char*>(&key.scale_factor),
+                    sizeof(scale_bits),
+                    reinterpret_cast<char*>(&scale_bits));
+
+        for(uint64_t val : {static_cast<uint64_t>(key.placement),
+                            static_cast<uint64_t>(key.transform_type),
+                            static_cast<uint64_t>(key.precision),
+                            static_cast<uint64_t>(key.dim),
+                            static_cast<uint64_t>(key.number_of_transforms),
+                            static_cast<uint64_t>(key.has_layout),
+                            static_cast<uint64_t>(key.inArrayType),
+                            static_cast<uint64_t>(key.outArrayType),
+                            static_cast<uint64_t>(key.inDist),
+                            static_cast<uint64_t>(key.outDist),
+                            scale_bits})
+            put(out, val);
+        for(const auto& arr : {key.lengths, key.inStrides, key.outStrides})
+            for(auto val : arr)
+                put(out, val);
+    }
+
+    static bool get_key(reader& r, hipfft_plan_key& key)
+    {
+        std::array<uint64_t, 11> vals;
+        for(auto& val : vals)
+            if(!r.get(val))
+                return false;
+        for(auto arr : {&key.lengths, &key.inStrides, &key.outStrides})
+        {
+            for(auto& val : *arr)
+            {
+                uint64_t v = 0;
+                if(!r.get(v))
+                    return false;
+                val = v;
+            }
+        }
+
+        key.device               = 0;
+        key.placement            = static_cast<rocfft_result_placement>(vals[0]);
+        key.transform_type       = static_cast<rocfft_transform_type>(vals[1]);
+        key.precision            = static_cast<rocfft_precision>(vals[2]);
+        key.dim                  = vals[3];
+        key.number_of_transforms = vals[4];
+        key.has_layout           = vals[5] != 0;
+        key.inArrayType          = static_cast<rocfft_array_type>(vals[6]);
+        key.outArrayType         = static_cast<rocfft_array_type>(vals[7]);
+        key.inDist               = vals[8];
+        key.outDist              = vals[9];
+        std::copy_n(reinterpret_cast<const char*>(&vals[10]),
+                    sizeof(key.scale_factor),
+                    reinterpret_cast<char*>(&key.scale_factor));
+        return true;
+    }
+
+    using entry = std::pair<entry_key, size_t>;
+
+    std::mutex                                      mutex;
+    std::list<entry>                                lru;
+    std::map<entry_key, std::list<entry>::iterator> index;
+    std::map<int, std::string>                      archs;
+};
+
+static void hipfftRecordWisdom(const hipfft_plan_key& key, size_t workBufferSize)
+{
+    hipfft_wisdom::get().record(key, workBufferSize);
+}
+
+// Create (or find in the plan cache) the rocfft_plan for a sub-plan,
+// and return how much work buffer it needs.
+//
+// Size queries only need the size.  They take it from the wisdom if
+// a plan with the same key was created before, and otherwise create
+// a plan that stays out of the plan cache, so that sizing many
+// candidate transforms doesn't evict the plans in use.
+static hipfftResult
+    hipfftCreateSubplan(hipfft_subplan& subplan, size_t& workBufferSize, bool size_only = false)
+{
+    workBufferSize    = 0;
+    subplan.attempted = true;
+    subplan.sized     = false;
+    if(!subplan.valid)
+        return HIPFFT_SUCCESS;
+
+    if(size_only)
+    {
+        subplan.sized = hipfft_wisdom::get().lookup(subplan.key, workBufferSize);
+        if(subplan.sized)
+            return HIPFFT_SUCCESS;
+        rocfft_plan_ptr rplan;
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateRocfftPlan(subplan.key, rplan));
+        if(!rplan)
+            return HIPFFT_SUCCESS;
+        ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_get_work_buffer_size(rplan.get(), &workBufferSize));
+        subplan.sized = true;
+        return HIPFFT_SUCCESS;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto res   = hipfft_plan_cache::get().find_or_create(subplan.key, subplan.rplan);
+    subplan.build_seconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    HIP_FFT_CHECK_AND_RETURN(res);
+    if(subplan.rplan)
+    {
+        ROC_FFT_CHECK_INVALID_VALUE(
+            rocfft_plan_get_work_buffer_size(subplan.rplan.get(), &workBufferSize));
+        subplan.sized = true;
+    }
+    return HIPFFT_SUCCESS;
+}
+
+// State shared between the threads creating a plan's sub-plans
+// concurrently.  Each sub-plan is created by whichever thread claims
+// it first: a pool worker or the thread that made the plan.  The
+// latter never waits on a sub-plan that nobody has started, so this
+// can't deadlock even when plans are made on pool workers.
+struct hipfft_subplan_build
+{
+    std::array<hipfft_subplan*, 4>   subplans        = {};
+    std::array<size_t, 4>            workBufferSizes = {};
+    std::array<hipfftResult, 4>      results         = {};
+    std::array<std::atomic<bool>, 4> claimed         = {};
+    bool                             size_only       = false;
+
+    std::mutex              mutex;
+    std::condition_variable cv;
+    size_t                  finished = 0;
+
+    void try_create(size_t i)
+    {
+        if(claimed[i].exchange(true))
+            return;
+
+        // the current device is per-thread, and might not be set on
+        // pool workers
+        if(hipSetDevice(subplans[i]->key.device) != hipSuccess)
+            results[i] = HIPFFT_INVALID_DEVICE;
+        else
+            results[i] = hipfftCreateSubplan(*subplans[i], workBufferSizes[i], size_only);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++finished;
+        }
+        cv.notify_all();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]() { return finished == subplans.size(); });
+    }
+};
+
+// Create all of a plan's valid sub-plans, and return the largest
+// work buffer any of them needs.
+static hipfftResult hipfftCreateSubplans(hipfftHandle plan, size_t& workBufferSize)
+{
+    workBufferSize = 0;
+
+    const std::array<hipfft_subplan*, 4> subplans
+        = {&plan->ip_forward, &plan->op_forward, &plan->ip_inverse, &plan->op_inverse};
+    std::array<size_t, 4>       workBufferSizes = {};
+    std::array<hipfftResult, 4> results         = {};
+
+    const auto num_valid = std::count_if(
+        subplans.begin(), subplans.end(), [](hipfft_subplan* subplan) { return subplan->valid; });
+
+    const auto start = std::chrono::steady_clock::now();
+    if(plan->concurrent_build && num_valid > 1)
+    {
+        // pool tasks might outlive this function, if this thread
+        // claims all of the work before they start
+        auto build       = std::make_shared<hipfft_subplan_build>();
+        build->subplans  = subplans;
+        build->size_only = plan->size_query;
+        for(size_t i = 0; i < subplans.size(); ++i)
+        {
+            if(!subplans[i]->valid)
+                continue;
+            hipfft_thread_pool::get().submit([build, i]() {
+                build->try_create(i);
+                return HIPFFT_SUCCESS;
+            });
+        }
+        for(size_t i = 0; i < subplans.size(); ++i)
+            build->try_create(i);
+        build->wait();
+        workBufferSizes = build->workBufferSizes;
+        results         = build->results;
+    }
+    else
+    {
+        for(size_t i = 0; i < subplans.size(); ++i)
+            results[i]
+                = hipfftCreateSubplan(*subplans[i], workBufferSizes[i], plan->size_query);
+    }
+    plan->build_seconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for(auto res : results)
+        HIP_FFT_CHECK_AND_RETURN(res);
+    workBufferSize = *std::max_element(workBufferSizes.begin(), workBufferSizes.end());
+    return HIPFFT_SUCCESS;
+}
+
+// Create the plan's sub-plans for the batch in their keys, and if
+// their work buffer would exceed the plan's memory limit, for a
+// smaller batch that fits instead.  Executions then split the
+// caller's batch into several of those.
+static hipfftResult hipfftCreateSubplansWithinLimit(hipfftHandle plan, size_t& workBufferSize)
+{
+    const std::array<hipfft_subplan*, 4> subplans
+        = {&plan->ip_forward, &plan->op_forward, &plan->ip_inverse, &plan->op_inverse};
+    const size_t batch = plan->ip_forward.key.number_of_transforms;
+    for(auto subplan : subplans)
+    {
+        subplan->total_transforms = batch;
+        subplan->remainder_rplan.reset();
+    }
+
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplans(plan, workBufferSize));
+    if(!plan->memory_limit || workBufferSize <= plan->memory_limit)
+        return HIPFFT_SUCCESS;
+
+    size_t sub_batch = batch;
+    while(workBufferSize > plan->memory_limit)
+    {
+        if(sub_batch <= 1)
+            return HIPFFT_ALLOC_FAILED;
+
+        // work buffers grow roughly in proportion to the batch, so
+        // guess from that but at least halve each time
+        const double ratio = static_cast<double>(plan->memory_limit) / workBufferSize;
+        sub_batch          = std::max<size_t>(
+            1, std::min(sub_batch / 2, static_cast<size_t>(sub_batch * ratio)));
+
+        for(auto subplan : subplans)
+        {
+            subplan->key.number_of_transforms = sub_batch;
+            subplan->rplan.reset();
+            subplan->attempted = false;
+        }
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplans(plan, workBufferSize));
+    }
+
+    // the last piece of the batch needs a plan of its own if it's
+    // smaller than the others
+    const size_t remainder = batch % sub_batch;
+    if(remainder == 0)
+        return HIPFFT_SUCCESS;
+    for(auto subplan : subplans)
+    {
+        if(!subplan->sized)
+            continue;
+        hipfft_subplan last;
+        last.key                      = subplan->key;
+        last.key.number_of_transforms = remainder;
+        last.valid                    = true;
+        size_t lastWorkBufferSize     = 0;
+        HIP_FFT_CHECK_AND_RETURN(
+            hipfftCreateSubplan(last, lastWorkBufferSize, plan->size_query));
+        if(!last.sized)
+            return HIPFFT_PARSE_ERROR;
+        subplan->remainder_rplan = std::move(last.rplan);
+        workBufferSize           = std::max(workBufferSize, lastWorkBufferSize);
+    }
+    return HIPFFT_SUCCESS;
+}
+
+// Create the sub-plans for each of the plan's dynamic scale factors,
+// from the plan's own sub-plans, and return the largest work buffer
+// any of them needs.  They go through the plan cache like any other,
+// and under a memory limit split the batch the same way.
+static hipfftResult hipfftCreateScaledSubplans(hipfftHandle plan, size_t& workBufferSize)
+{
+    workBufferSize = 0;
+    plan->scaled_subplans.clear();
+
+    const std::array<const hipfft_subplan*, 4> subplans
+        = {&plan->ip_forward, &plan->op_forward, &plan->ip_inverse, &plan->op_inverse};
+    for(auto scale : plan->dynamic_scales)
+    {
+        if(scale == plan->scale_factor || plan->scaled_subplans.count(scale))
+            continue;
+        auto& variants = plan->scaled_subplans[scale];
+        for(size_t i = 0; i < subplans.size(); ++i)
+        {
+            const auto& base = *subplans[i];
+            if(!base.sized)
+                continue;
+            auto& variant            = variants[i];
+            variant.key              = base.key;
+            variant.key.scale_factor = scale;
+            variant.valid            = true;
+            variant.total_transforms = base.total_transforms;
+            size_t size              = 0;
+            HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplan(variant, size, plan->size_query));
+            if(!variant.sized)
+                return HIPFFT_PARSE_ERROR;
+            workBufferSize = std::max(workBufferSize, size);
+
+            const size_t remainder = base.total_transforms % base.key.number_of_transforms;
+            if(remainder == 0)
+                continue;
+            hipfft_subplan last;
+            last.key                      = variant.key;
+            last.key.number_of_transforms = remainder;
+            last.valid                    = true;
+            HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplan(last, size, plan->size_query));
+            if(!last.sized)
+                return HIPFFT_PARSE_ERROR;
+            variant.remainder_rplan = std::move(last.rplan);
+            workBufferSize          = std::max(workBufferSize, size);
+        }
+    }
+    return HIPFFT_SUCCESS;
+}
+
+// Process-wide pool of work buffers, which plans in
+// HIPFFT_EXT_WORKBUFFER_POOL mode borrow for each execution.
+//
+// Borrowing is stream-ordered: a returned buffer has an event
+// recorded on the stream that last used it.  A later borrower on a
+// different stream makes its stream wait for that event, so reuse
+// never blocks the host.  Buffers are bucketed into power-of-two
+// size classes so that plans with similar needs share them.
+//
+// Buffers are kept until the pool is trimmed, or the process exits.
+class hipfft_workbuffer_pool
+{
+public:
+    struct block
+    {
+        void*       ptr      = nullptr;
+        size_t      size     = 0;
+        int         device   = 0;
+        hipEvent_t  released = nullptr;
+        hipStream_t stream   = nullptr;
+    };
+
+    static hipfft_workbuffer_pool& get()
+    {
+        static hipfft_workbuffer_pool pool;
+        return pool;
+    }
+
+    // Borrow a buffer of at least the given size on the current
+    // device, for use on the given stream.
+    hipfftResult acquire(size_t size, hipStream_t stream, block& out)
+    {
+        int device = 0;
+        if(hipGetDevice(&device) != hipSuccess)
+            return HIPFFT_INVALID_DEVICE;
+
+        size_t size_class = min_size_class;
+        while(size_class < size)
+            size_class *= 2;
+
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto&                       bucket = free_blocks[std::make_pair(device, size_class)];
+
+            // prefer a buffer last used on the same stream, which is
+            // already ordered after that use
+            auto it = std::find_if(
+                bucket.begin(), bucket.end(), [=](const block& b) { return b.stream == stream; });
+            if(it == bucket.end() && !bucket.empty())
+                it = std::prev(bucket.end());
+            if(it != bucket.end())
+            {
+                out = *it;
+                bucket.erase(it);
+                bytes_in_use += out.size;
+                ++reuses;
+                found = true;
+            }
+        }
+        if(found)
+        {
+            if(out.stream != stream && hipStreamWaitEvent(stream, out.released, 0) != hipSuccess)
+            {
+                release(out, out.stream);
+                return HIPFFT_EXEC_FAILED;
+            }
+            return HIPFFT_SUCCESS;
+        }
+
+        out        = block();
+        out.size   = size_class;
+        out.device = device;
+        if(hipfftDeviceMalloc(&out.ptr, size_class) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        if(hipEventCreateWithFlags(&out.released, hipEventDisableTiming) != hipSuccess)
+        {
+            hipFree(out.ptr);
+            return HIPFFT_ALLOC_FAILED;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++allocations;
+        bytes_allocated += size_class;
+        bytes_in_use += size_class;
+        high_water_bytes = std::max(high_water_bytes, bytes_allocated);
+        return HIPFFT_SUCCESS;
+    }
+
+    // Return a borrowed buffer once work using it has been enqueued
+    // on the stream.
+    void release(block& b, hipStream_t stream)
+    {
+        b.stream = stream;
+        hipEventRecord(b.released, stream);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes_in_use -= b.size;
+        free_blocks[std::make_pair(b.device, b.size)].push_back(b);
+    }
+
+    // Free all buffers that aren't borrowed.  Returns the number of
+    // bytes freed.
+    size_t trim()
+    {
+        std::vector<block> to_free;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto& bucket : free_blocks)
+                to_free.insert(to_free.end(), bucket.second.begin(), bucket.second.end());
+            free_blocks.clear();
+        }
+
+        size_t freed = 0;
+        for(auto& b : to_free)
+        {
+            hipEventSynchronize(b.released);
+            hipEventDestroy(b.released);
+            hipFree(b.ptr);
+            freed += b.size;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes_allocated -= freed;
+        return freed;
+    }
+
+    void get_stats(hipfftExtWorkBufferPoolStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.bytes_allocated  = bytes_allocated;
+        stats.bytes_in_use     = bytes_in_use;
+        stats.high_water_bytes = high_water_bytes;
+        stats.allocations      = allocations;
+        stats.reuses           = reuses;
+    }
+
+private:
+    hipfft_workbuffer_pool() = default;
+
+    static constexpr size_t min_size_class = 1 << 16;
+
+    std::mutex                                            mutex;
+    std::map<std::pair<int, size_t>, std::vector<block>> free_blocks;
+
+    size_t bytes_allocated  = 0;
+    size_t bytes_in_use     = 0;
+    size_t high_water_bytes = 0;
+    size_t allocations      = 0;
+    size_t reuses           = 0;
+};
+
+// Process-wide pool of pinned host buffers, used to bounce copies
+// between pageable host memory and the device.  The device copies
+// pinned memory at full bandwidth, and reusing the buffers avoids
+// pinning memory on every call.
+//
+// The host writes and reads these buffers, so a returned buffer is
+// only handed out again once the device work using it is done.  The
+// pool allocates no more than its limit; copies that would need more
+// go directly to or from the pageable memory.
+class hipfft_pinned_pool
+{
+public:
+    struct block
+    {
+        void*      ptr      = nullptr;
+        size_t     size     = 0;
+        hipEvent_t released = nullptr;
+    };
+
+    static hipfft_pinned_pool& get()
+    {
+        static hipfft_pinned_pool pool;
+        return pool;
+    }
+
+    // Borrow a buffer of at least the given size, once the device is
+    // done with it.  Fails with HIPFFT_ALLOC_FAILED if the pool is at
+    // its limit.
+    hipfftResult acquire(size_t size, block& out)
+    {
+        size_t size_class = min_size_class;
+        while(size_class < size)
+            size_class *= 2;
+
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto&                       bucket = free_blocks[size_class];
+
+            // prefer a buffer the device is already done with
+            auto it = std::find_if(bucket.begin(), bucket.end(), [](const block& b) {
+                return hipEventQuery(b.released) == hipSuccess;
+            });
+            if(it == bucket.end() && !bucket.empty())
+                it = bucket.begin();
+            if(it != bucket.end())
+            {
+                out = *it;
+                bucket.erase(it);
+                bytes_in_use += out.size;
+                ++reuses;
+                found = true;
+            }
+        }
+        if(found)
+        {
+            if(hipEventSynchronize(out.released) != hipSuccess)
+            {
+                release(out, nullptr);
+                return HIPFFT_EXEC_FAILED;
+            }
+            return HIPFFT_SUCCESS;
+        }
+
+        // make room by freeing idle buffers of other sizes
+        if(!reserve(size_class))
+        {
+            trim();
+            if(!reserve(size_class))
+                return HIPFFT_ALLOC_FAILED;
+        }
+
+        out      = block();
+        out.size = size_class;
+        if(hipHostMalloc(&out.ptr, size_class, hipHostMallocDefault) != hipSuccess)
+        {
+            unreserve(size_class);
+            return HIPFFT_ALLOC_FAILED;
+        }
+        if(hipEventCreateWithFlags(&out.released, hipEventDisableTiming) != hipSuccess)
+        {
+            hipHostFree(out.ptr);
+            unreserve(size_class);
+            return HIPFFT_ALLOC_FAILED;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++allocations;
+        bytes_in_use += size_class;
+        return HIPFFT_SUCCESS;
+    }
+
+    // Return a borrowed buffer once work using it has been enqueued
+    // on the stream.
+    void release(block& b, hipStream_t stream)
+    {
+        hipEventRecord(b.released, stream);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes_in_use -= b.size;
+        free_blocks[b.size].push_back(b);
+    }
+
+    // Free all buffers that aren't borrowed.  Returns the number of
+    // bytes freed.
+    size_t trim()
+    {
+        std::vector<block> to_free;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto& bucket : free_blocks)
+                to_free.insert(to_free.end(), bucket.second.begin(), bucket.second.end());
+            free_blocks.clear();
+        }
+
+        size_t freed = 0;
+        for(auto& b : to_free)
+        {
+            hipEventSynchronize(b.released);
+            hipEventDestroy(b.released);
+            hipHostFree(b.ptr);
+            freed += b.size;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes_allocated -= freed;
+        return freed;
+    }
+
+    void set_limit(size_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            limit = bytes;
+            if(bytes_allocated <= limit)
+                return;
+        }
+        trim();
+    }
+
+    // Count a copy that bypassed the pool
+    void count_fallback()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++fallbacks;
+    }
+
+    void get_stats(hipfftExtPinnedPoolStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.bytes_limit      = limit;
+        stats.bytes_allocated  = bytes_allocated;
+        stats.bytes_in_use     = bytes_in_use;
+        stats.high_water_bytes = high_water_bytes;
+        stats.allocations      = allocations;
+        stats.reuses           = reuses;
+        stats.fallbacks        = fallbacks;
+    }
+
+private:
+    hipfft_pinned_pool() = default;
+
+    // Count size bytes against the limit, if they fit
+    bool reserve(size_t size)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(bytes_allocated + size > limit)
+            return false;
+        bytes_allocated += size;
+        high_water_bytes = std::max(high_water_bytes, bytes_allocated);
+        return true;
+    }
+
+    void unreserve(size_t size)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes_allocated -= size;
+    }
+
+    static constexpr size_t min_size_class = 1 << 16;
+
+    std::mutex                            mutex;
+    std::map<size_t, std::vector<block>> free_blocks;
+
+    size_t limit            = size_t(256) << 20;
+    size_t bytes_allocated  = 0;
+    size_t bytes_in_use     = 0;
+    size_t high_water_bytes = 0;
+    size_t allocations      = 0;
+    size_t reuses           = 0;
+    size_t fallbacks        = 0;
+};
+
+// Process-wide free lists of plan handles and execution infos, so
+// that creating and destroying plans doesn't go to the heap or
+// rocFFT each time.
+//
+// Handles are carved out of fixed-size slabs that are kept until the
+// process exits.  An execution info is only recycled if it never had
+// a work buffer set, since rocFFT can't clear one; the stream and
+// callbacks are reset before reuse.
+class hipfft_handle_pool
+{
+public:
+    static hipfft_handle_pool& get()
+    {
+        // the pool holds on to execution infos
+        rocfft_init_once();
+        static hipfft_handle_pool pool;
+        return pool;
+    }
+
+    ~hipfft_handle_pool()
+    {
+        for(auto info : free_infos)
+            rocfft_execution_info_destroy(info);
+    }
+
+    // Construct a handle with an execution info
+    hipfftResult acquire(hipfftHandle& plan)
+    {
+        void*                 storage = nullptr;
+        rocfft_execution_info info    = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(free_slots.empty())
+            {
+                slabs.emplace_back(new slot[slab_size]);
+                for(size_t i = 0; i < slab_size; ++i)
+                    free_slots.push_back(&slabs.back()[slab_size - 1 - i]);
+            }
+            storage = free_slots.back();
+            free_slots.pop_back();
+            if(!free_infos.empty())
+            {
+                info = free_infos.back();
+                free_infos.pop_back();
+            }
+        }
+
+        if(!info && rocfft_execution_info_create(&info) != rocfft_status_success)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            free_slots.push_back(storage);
+            return HIPFFT_INVALID_VALUE;
+        }
+        plan       = new(storage) hipfftHandle_t;
+        plan->info = info;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        plan->next_live = live;
+        if(live)
+            live->prev_live = plan;
+        live = plan;
+        return HIPFFT_SUCCESS;
+    }
+
+    // Take a handle that's about to be destroyed out of the list of
+    // live handles.  Waits for a for_each_live call in progress.
+    void retire(hipfftHandle plan)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(plan->prev_live)
+            plan->prev_live->next_live = plan->next_live;
+        else if(live == plan)
+            live = plan->next_live;
+        if(plan->next_live)
+            plan->next_live->prev_live = plan->prev_live;
+        plan->prev_live = plan->next_live = nullptr;
+    }
+
+    // Call f on each live handle.  Handles can't be destroyed
+    // meanwhile.
+    template <typename F>
+    void for_each_live(F f)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto plan = live; plan; plan = plan->next_live)
+            f(plan);
+    }
+
+    // Destroy a handle from acquire, keeping its storage and
+    // execution info for reuse
+    hipfftResult release(hipfftHandle plan)
+    {
+        auto info    = plan->info;
+        bool recycle = info && !plan->info_has_work_buffer
+                       && rocfft_execution_info_set_stream(info, nullptr) == rocfft_status_success
+                       && rocfft_execution_info_set_load_callback(info, nullptr, nullptr, 0)
+                              == rocfft_status_success
+                       && rocfft_execution_info_set_store_callback(info, nullptr, nullptr, 0)
+                              == rocfft_status_success;
+        auto res = HIPFFT_SUCCESS;
+        if(info && !recycle && rocfft_execution_info_destroy(info) != rocfft_status_success)
+            res = HIPFFT_INVALID_VALUE;
+
+        plan->~hipfftHandle_t();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        free_slots.push_back(plan);
+        if(recycle)
+            free_infos.push_back(info);
+        return res;
+    }
+
+private:
+    hipfft_handle_pool() = default;
+
+    typedef std::aligned_storage_t<sizeof(hipfftHandle_t), alignof(hipfftHandle_t)> slot;
+    static constexpr size_t slab_size = 64;
+
+    std::mutex                           mutex;
+    std::vector<std::unique_ptr<slot[]>> slabs;
+    std::vector<void*>                   free_slots;
+    std::vector<rocfft_execution_info>   free_infos;
+    hipfftHandle                         live = nullptr;
+};
+
+// Point the plan's execution info at a work buffer
+static rocfft_status hipfftSetInfoWorkBuffer(hipfftHandle plan, void* buffer, size_t size)
+{
+    plan->info_has_work_buffer = true;
+    return rocfft_execution_info_set_work_buffer(plan->info, buffer, size);
+}
+
+// Make sure the group's buffer holds at least the given size, and
+// point all of its plans at it
+static hipfftResult hipfftWorkAreaGroupUpdate(hipfftExtWorkAreaGroup group, size_t size)
+{
+    if(size > group->size)
+    {
+        // hipFree waits for work that might still be using the old
+        // buffer
+        if(group->buffer && hipFree(group->buffer) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        group->buffer = nullptr;
+        group->size   = 0;
+        if(hipfftDeviceMalloc(&group->buffer, size) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        group->size = size;
+    }
+    for(auto member : group->plans)
+    {
+        ROC_FFT_CHECK_INVALID_VALUE(
+            hipfftSetInfoWorkBuffer(member, group->buffer, group->size));
+    }
+    return HIPFFT_SUCCESS;
+}
+
+// Take a plan out of its work area group, shrinking the group's
+// buffer to what the remaining plans need
+static hipfftResult hipfftWorkAreaGroupDetach(hipfftHandle plan)
+{
+    auto group = plan->work_area_group;
+    if(!group)
+        return HIPFFT_SUCCESS;
+    group->plans.erase(std::remove(group->plans.begin(), group->plans.end(), plan),
+                       group->plans.end());
+    plan->work_area_group = nullptr;
+
+    size_t needed = 0;
+    for(auto member : group->plans)
+        needed = std::max(needed, member->workBufferSize);
+    if(needed < group->size)
+    {
+        if(hipFree(group->buffer) != hipSuccess)
+            return HIPFFT_ALLOC_FAILED;
+        group->buffer = nullptr;
+        group->size   = 0;
+        if(needed > 0)
+            return hipfftWorkAreaGroupUpdate(group, needed);
+    }
+    return HIPFFT_SUCCESS;
+}
+
+// Free the plan's automatically-allocated work buffer, if it has one
+static hipfftResult hipfftFreeWorkBuffer(hipfftHandle plan)
+{
+    auto res = HIPFFT_SUCCESS;
+    if(plan->workBuffer && plan->workBufferNeedsFree)
+    {
+        // stream-ordered buffers are released once work already
+        // queued on their stream is done with them
+        const auto err = plan->workBufferAsync
+                             ? hipFreeAsync(plan->workBuffer, plan->workBufferStream)
+                             : hipFree(plan->workBuffer);
+        if(err != hipSuccess)
+            res = HIPFFT_ALLOC_FAILED;
+    }
+    plan->workBuffer          = nullptr;
+    plan->workBufferNeedsFree = false;
+    plan->workBufferAllocSize = 0;
+    plan->workBufferAsync     = false;
+    plan->workBufferStream    = nullptr;
+    return res;
+}
+
+// Free memory the library holds but isn't using: work buffers,
+// staging buffers and captured graphs of plans that aren't executing,
+// and what the pools and plan cache keep for reuse.  Plans the
+// current thread holds are left alone.
+static hipfftResult hipfftTrimIdleMemory()
+{
+    auto res = HIPFFT_SUCCESS;
+    hipfft_handle_pool::get().for_each_live([&](hipfftHandle plan) {
+        if(hipfft_plan_lock::held_by_this_thread(plan))
+            return;
+        // leave plans that are executing alone
+        std::unique_lock<std::mutex> lock(plan->buffer_mutex, std::try_to_lock);
+        if(!lock.owns_lock())
+            return;
+        if(plan->workBufferNeedsFree && hipfftFreeWorkBuffer(plan) != HIPFFT_SUCCESS)
+            res = HIPFFT_ALLOC_FAILED;
+        plan->staging.reset();
+        plan->ooc_scratch.reset();
+        plan->ooc_scratch_bytes = 0;
+        plan->graphs.reset();
+    });
+    hipfft_workbuffer_pool::get().trim();
+    hipfft_pinned_pool::get().trim();
+    hipfft_plan_cache::get().trim();
+    return res;
+}
+
+// Allocate the plan's work buffer now, on the plan's stream if the
+// plan asked for stream-ordered allocation and it's allowed
+static hipfftResult
+    hipfftAllocWorkBufferNow(hipfftHandle plan, size_t workBufferSize, bool allow_async = true)
+{
+    const bool async
+        = allow_async && plan->workBufferMode == HIPFFT_EXT_WORKBUFFER_DEFERRED_ASYNC;
+    if(hipfftDeviceMalloc(&plan->workBuffer, workBufferSize, plan->stream, async) != hipSuccess)
+        return HIPFFT_ALLOC_FAILED;
+    plan->workBufferNeedsFree = true;
+    plan->workBufferAllocSize = workBufferSize;
+    plan->workBufferAsync     = async;
+    plan->workBufferStream    = plan->stream;
+    ROC_FFT_CHECK_INVALID_VALUE(
+        hipfftSetInfoWorkBuffer(plan, plan->workBuffer, workBufferSize));
+    return HIPFFT_SUCCESS;
+}
+
+// Replace the plan's automatically-allocated work buffer with a new
+// one of the given size
+static hipfftResult hipfftAllocWorkBuffer(hipfftHandle plan, size_t workBufferSize)
+{
+    hipfft_plan_lock lock(plan);
+    HIP_FFT_CHECK_AND_RETURN(hipfftFreeWorkBuffer(plan));
+
+    if(plan->work_area_group)
+        return hipfftWorkAreaGroupUpdate(plan->work_area_group, workBufferSize);
+
+    // pooled work buffers are borrowed at execution time, and
+    // deferred ones allocated on first execution, instead
+    if(plan->workBufferMode != HIPFFT_EXT_WORKBUFFER_EAGER)
+        return HIPFFT_SUCCESS;
+
+    return hipfftAllocWorkBufferNow(plan, workBufferSize);
+}
+
+// Make sure the plan's automatically-allocated work buffer is at
+// least the given size, keeping the current one if it's big enough
+static hipfftResult hipfftGrowWorkBuffer(hipfftHandle plan, size_t workBufferSize)
+{
+    if(plan->workBufferNeedsFree && plan->workBufferAllocSize >= workBufferSize)
+        return HIPFFT_SUCCESS;
+    return hipfftAllocWorkBuffer(plan, workBufferSize);
+}
+
+// Pass the plan's callbacks on to its rocfft_execution_info
+static hipfftResult hipfftSetInfoCallbacks(hipfftHandle plan)
+{
+    rocfft_status res;
+    res = rocfft_execution_info_set_load_callback(plan->info,
+                                                  plan->load_callback_ptrs,
+                                                  plan->load_callback_data,
+                                                  plan->load_callback_lds_bytes);
+    if(res != rocfft_status_success)
+        return HIPFFT_INVALID_VALUE;
+    res = rocfft_execution_info_set_store_callback(plan->info,
+                                                   plan->store_callback_ptrs,
+                                                   plan->store_callback_data,
+                                                   plan->store_callback_lds_bytes);
+    if(res != rocfft_status_success)
+        return HIPFFT_INVALID_VALUE;
+    return HIPFFT_SUCCESS;
+}
+
+// Forget what executions derived from the plan's sub-plans, when
+// they are replaced.  Trimming memory under pressure on another
+// thread may be resetting the graphs meanwhile, so lock.
+static void hipfftForgetDerivedPlans(hipfftHandle plan)
+{
+    hipfft_plan_lock lock(plan);
+    plan->batch_subplans.clear();
+    plan->graphs.reset();
+}
+
+// Wait for background plan creation on the handle to finish, and
+// take over the plans it created.  Returns the result of the
+// creation, which is remembered until the handle is planned again.
+static hipfftResult hipfftFinishPending(hipfftHandle plan)
+{
+    if(!plan->pending_plan.valid())
+        return plan->pending_status;
+
+    plan->pending_status = plan->pending_plan.get();
+    auto staged          = std::move(plan->pending_staged);
+    if(plan->pending_status != HIPFFT_SUCCESS)
+        return plan->pending_status;
+
+    plan->type            = staged->type;
+    plan->ip_forward      = std::move(staged->ip_forward);
+    plan->op_forward      = std::move(staged->op_forward);
+    plan->ip_inverse      = std::move(staged->ip_inverse);
+    plan->op_inverse      = std::move(staged->op_inverse);
+    plan->ooc             = std::move(staged->ooc);
+    plan->scaled_subplans = std::move(staged->scaled_subplans);
+    plan->workBufferSize  = staged->workBufferSize;
+    plan->build_seconds   = staged->build_seconds;
+    hipfftForgetDerivedPlans(plan);
+
+    // the work buffer is allocated here rather than on the worker,
+    // since it's associated with the caller's device and info
+    if(plan->workBufferSize > 0 && plan->autoAllocate)
+        plan->pending_status = hipfftAllocWorkBuffer(plan, plan->workBufferSize);
+    return plan->pending_status;
+}
+
+hipfftResult hipfftPlan1d(hipfftHandle* plan, int nx, hipfftType type, int batch)
+{
+    hipfftHandle handle = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
+    *plan = handle;
+
+    return hipfftMakePlan1d(*plan, nx, type, batch, nullptr);
+}
+
+hipfftResult hipfftPlan2d(hipfftHandle* plan, int nx, int ny, hipfftType type)
+{
+    hipfftHandle handle = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
+    *plan = handle;
+
+    return hipfftMakePlan2d(*plan, nx, ny, type, nullptr);
+}
+
+hipfftResult hipfftPlan3d(hipfftHandle* plan, int nx, int ny, int nz, hipfftType type)
+{
+    hipfftHandle handle = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
+    *plan = handle;
+
+    return hipfftMakePlan3d(*plan, nx, ny, nz, type, nullptr);
+}
+
+hipfftResult hipfftPlanMany(hipfftHandle* plan,
+                            int           rank,
+                            int*          n,
+                            int*          inembed,
+                            int           istride,
+                            int           idist,
+                            int*          onembed,
+                            int           ostride,
+                            int           odist,
+                            hipfftType    type,
+                            int           batch)
+{
+    hipfftHandle handle = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
+    *plan = handle;
+
+    return hipfftMakePlanMany(
+        *plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, nullptr);
+}
+
+hipfftResult hipfftPlanMany64(hipfftHandle*  plan,
+                              int            rank,
+                              long long int* n,
+                              long long int* inembed,
+                              long long int  istride,
+                              long long int  idist,
+                              long long int* onembed,
+                              long long int  ostride,
+                              long long int  odist,
+                              hipfftType     type,
+                              long long int  batch)
+{
+    hipfftHandle handle = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&handle));
+    *plan = handle;
+
+    return hipfftMakePlanMany64(
+        *plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, nullptr);
+}
+
+hipfftResult hipfftMakePlan_internal(hipfftHandle               plan,
+                                     size_t                     dim,
+                                     size_t*                    lengths,
+                                     hipfftIOType               iotype,
+                                     size_t                     number_of_transforms,
+                                     hipfft_plan_description_t* desc,
+                                     size_t*                    workSize,
+                                     bool                       re_calc_strides_in_desc)
+{
+    // forget about any sub-plans from a previous MakePlan call,
+    // including one that might still be running in the background
+    plan->pending_plan   = std::future<hipfftResult>();
+    plan->pending_staged = nullptr;
+    plan->pending_status = HIPFFT_SUCCESS;
+    for(auto subplan : {&plan->ip_forward, &plan->op_forward, &plan->ip_inverse, &plan->op_inverse})
+        *subplan = hipfft_subplan();
+    plan->scaled_subplans.clear();
+    plan->ooc.reset();
+    hipfftForgetDerivedPlans(plan);
+
+    auto& ip_forward_key = plan->ip_forward.key;
+    auto& op_forward_key = plan->op_forward.key;
+    auto& ip_inverse_key = plan->ip_inverse.key;
+    auto& op_inverse_key = plan->op_inverse.key;
+
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        return HIPFFT_INVALID_DEVICE;
+
+    for(auto key : {&ip_forward_key, &op_forward_key, &ip_inverse_key, &op_inverse_key})
+    {
+        key->device    = device;
+        key->precision = iotype.precision();
+        key->dim       = dim;
+        std::copy_n(lengths, dim, key->lengths.begin());
+        key->number_of_transforms = number_of_transforms;
+        key->scale_factor         = plan->scale_factor;
+    }
+    ip_forward_key.placement = rocfft_placement_inplace;
+    op_forward_key.placement = rocfft_placement_notinplace;
+    ip_inverse_key.placement = rocfft_placement_inplace;
+    op_inverse_key.placement = rocfft_placement_notinplace;
+
+    if(desc != nullptr)
+    {
+        size_t i_strides[3] = {desc->inStrides[0], desc->inStrides[1], desc->inStrides[2]};
+        size_t o_strides[3] = {desc->outStrides[0], desc->outStrides[1], desc->outStrides[2]};
+
+        if(re_calc_strides_in_desc)
+        {
+            if(desc->inArrayType == rocfft_array_type_real) // real-to-complex
+            {
+                size_t idist = 2 * (1 + lengths[0] / 2);
+                size_t odist = 1 + lengths[0] / 2;
+                for(size_t i = 1; i < dim; i++)
+                {
+                    i_strides[i] = idist;
+                    idist *= lengths[i];
+                    o_strides[i] = odist;
+                    odist *= lengths[i];
+                }
+
+                ip_forward_key.set_layout(*desc, i_strides, idist, o_strides, odist);
+
+                idist = lengths[0];
+                odist = 1 + lengths[0] / 2;
+                for(size_t i = 1; i < dim; i++)
+                {
+                    i_strides[i] = idist;
+                    idist *= lengths[i];
+                    o_strides[i] = odist;
+                    odist *= lengths[i];
+                }
+
+                op_forward_key.set_layout(*desc, i_strides, idist, o_strides, odist);
+            }
+            else if(desc->outArrayType == rocfft_array_type_real) // complex-to-real
+            {
+                size_t idist = 1 + lengths[0] / 2;
+                size_t odist = 2 * (1 + lengths[0] / 2);
+                for(size_t i = 1; i < dim; i++)
+                {
+                    i_strides[i] = idist;
+                    idist *= lengths[i];
+                    o_strides[i] = odist;
+                    odist *= lengths[i];
+                }
+
+                ip_inverse_key.set_layout(*desc, i_strides, idist, o_strides, odist);
+
+                idist = 1 + lengths[0] / 2;
+                odist = lengths[0];
+                for(size_t i = 1; i < dim; i++)
+                {
+                    i_strides[i] = idist;
+                    idist *= lengths[i];
+                    o_strides[i] = odist;
+                    odist *= lengths[i];
+                }
+
+                op_inverse_key.set_layout(*desc, i_strides, idist, o_strides, odist);
+            }
+            else
+            {
+
+                size_t dist = lengths[0];
+                for(size_t i = 1; i < dim; i++)
+                {
+                    dist *= lengths[i];
+                }
+
+                for(auto key : {&ip_forward_key, &op_forward_key, &ip_inverse_key, &op_inverse_key})
+                    key->set_layout(*desc, i_strides, dist, o_strides, dist);
+            }
+        }
+        else
+        {
+            for(auto key : {&ip_forward_key, &op_forward_key, &ip_inverse_key, &op_inverse_key})
+                key->set_layout(*desc, i_strides, desc->inDist, o_strides, desc->outDist);
+        }
+    }
+
+    // only the sub-plans the caller said they'd execute are valid
+    bool any_valid = false;
+    for(auto t : iotype.transform_types())
+    {
+        const int direction_hint
+            = iotype.is_forward(t) ? HIPFFT_EXT_DIRECTION_FORWARD : HIPFFT_EXT_DIRECTION_BACKWARD;
+        if(!(plan->direction_hints & direction_hint))
+            continue;
+
+        auto& ip_subplan = iotype.is_forward(t) ? plan->ip_forward : plan->ip_inverse;
+        auto& op_subplan = iotype.is_forward(t) ? plan->op_forward : plan->op_inverse;
+        ip_subplan.key.transform_type = t;
+        ip_subplan.valid = plan->placement_hints & HIPFFT_EXT_PLACEMENT_INPLACE;
+        op_subplan.key.transform_type = t;
+        op_subplan.valid = plan->placement_hints & HIPFFT_EXT_PLACEMENT_NOTINPLACE;
+        any_valid        = any_valid || ip_subplan.valid || op_subplan.valid;
+    }
+    if(!any_valid)
+        return HIPFFT_INVALID_VALUE;
+    plan->type = iotype;
+
+    // count the number of plans that got created - it's possible to
+    // have parameters that are valid for out-place but not for
+    // in-place, so some of these rocfft_plan_creates could
+    // legitimately fail.
+    //
+    // lazy plans defer all of this to execution time.
+    //
+    // plans with a memory limit need their work buffer sizes up
+    // front, and plans with dynamic scale factors need all of their
+    // sub-plans to create the scaled ones from, so neither is lazy.
+    size_t workBufferSize = 0;
+    plan->build_seconds   = 0.0;
+    if(!plan->lazy_plans || plan->memory_limit || !plan->dynamic_scales.empty())
+    {
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplansWithinLimit(plan, workBufferSize));
+
+        // if no plans got created, fail
+        if(!plan->ip_forward.sized && !plan->op_forward.sized && !plan->ip_inverse.sized
+           && !plan->op_inverse.sized)
+            return HIPFFT_PARSE_ERROR;
+
+        size_t scaledWorkBufferSize = 0;
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateScaledSubplans(plan, scaledWorkBufferSize));
+        workBufferSize = std::max(workBufferSize, scaledWorkBufferSize);
+    }
+
+    if(workBufferSize > 0)
+    {
+        if(plan->autoAllocate)
+            HIP_FFT_CHECK_AND_RETURN(hipfftAllocWorkBuffer(plan, workBufferSize));
+    }
+
+    if(workSize != nullptr)
+        *workSize = workBufferSize;
+
+    plan->workBufferSize = workBufferSize;
+
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftCreate(hipfftHandle* plan)
+{
+    // NOTE: cufft backend uses int for handle type, so this wouldn't
+    // work using cufft types.  This is the rocfft backend, but
     // cppcheck doesn't know that.  Compiler would complain anyway
     // about making integer from pointer without a cast.
     //
@@ -739,430 +2774,1795 @@ hipfftResult hipfftCreate(hipfftHandle* plan)
     static_assert(sizeof(hipfftHandle) >= sizeof(void*),
                   "hipfftHandle type not wide enough for pointer");
     // cppcheck-suppress AssignmentAddressToInteger
-    hipfftHandle h = new hipfftHandle_t;
-    ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_create(&h->info));
+    hipfftHandle h = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(hipfft_handle_pool::get().acquire(h));
     *plan = h;
     return HIPFFT_SUCCESS;
 }
 
-hipfftResult hipfftExtPlanScaleFactor(hipfftHandle plan, double scalefactor)
+hipfftResult hipfftExtPlanScaleFactor(hipfftHandle plan, double scalefactor)
+{
+    if(!std::isfinite(scalefactor))
+        return HIPFFT_INVALID_VALUE;
+    plan->scale_factor = scalefactor;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanScaleDynamic(hipfftHandle plan, int count, const double scales[])
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(count < 0 || (count > 0 && !scales))
+        return HIPFFT_INVALID_VALUE;
+    if(!std::all_of(scales, scales + count, [](double scale) { return std::isfinite(scale); }))
+        return HIPFFT_INVALID_VALUE;
+    plan->dynamic_scales.assign(scales, scales + count);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanLazy(hipfftHandle plan, int lazy)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    plan->lazy_plans = bool(lazy);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanHints(hipfftHandle plan, int placement_mask, int direction_mask)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(placement_mask == 0 || (placement_mask & ~HIPFFT_EXT_PLACEMENT_ALL) || direction_mask == 0
+       || (direction_mask & ~HIPFFT_EXT_DIRECTION_ALL))
+        return HIPFFT_INVALID_VALUE;
+    plan->placement_hints = placement_mask;
+    plan->direction_hints = direction_mask;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanConcurrentBuild(hipfftHandle plan, int concurrent)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    plan->concurrent_build = bool(concurrent);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanGetBuildMetrics(hipfftHandle plan, hipfftExtPlanBuildMetrics* metrics)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(!metrics)
+        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+
+    metrics->total_seconds               = plan->build_seconds;
+    metrics->inplace_forward_seconds     = plan->ip_forward.build_seconds;
+    metrics->outofplace_forward_seconds  = plan->op_forward.build_seconds;
+    metrics->inplace_backward_seconds    = plan->ip_inverse.build_seconds;
+    metrics->outofplace_backward_seconds = plan->op_inverse.build_seconds;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanWorkBufferMode(hipfftHandle plan, hipfftExtWorkBufferMode mode)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(mode != HIPFFT_EXT_WORKBUFFER_EAGER && mode != HIPFFT_EXT_WORKBUFFER_POOL
+       && mode != HIPFFT_EXT_WORKBUFFER_DEFERRED && mode != HIPFFT_EXT_WORKBUFFER_DEFERRED_ASYNC)
+        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+
+    plan->workBufferMode = mode;
+
+    // switch an already-initialized plan over to the new mode.
+    // Deferred plans keep any buffer they already have.
+    if(plan->autoAllocate && plan->workBufferSize > 0)
+    {
+        const bool owns_buffer = plan->workBuffer && plan->workBufferNeedsFree;
+        if((mode == HIPFFT_EXT_WORKBUFFER_POOL && owns_buffer)
+           || (mode == HIPFFT_EXT_WORKBUFFER_EAGER && !owns_buffer))
+            HIP_FFT_CHECK_AND_RETURN(hipfftAllocWorkBuffer(plan, plan->workBufferSize));
+    }
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtSetMemoryLimit(hipfftHandle plan, size_t bytes)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    plan->memory_limit = bytes;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanPrefetchManaged(hipfftHandle plan, int prefetch)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    plan->prefetch_managed = bool(prefetch);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanGetPrefetchStats(hipfftHandle plan, hipfftExtPrefetchStats* stats)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(!stats)
+        return HIPFFT_INVALID_VALUE;
+    stats->bytes_prefetched = plan->prefetch_bytes;
+    stats->prefetches       = plan->prefetches;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanHostStaging(hipfftHandle plan, int depth, long long int chunk)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(depth < 0 || chunk < 0)
+        return HIPFFT_INVALID_VALUE;
+    plan->staging_depth = depth;
+    plan->staging_chunk = chunk;
+    // buffers are (re)allocated on the next staged execution
+    plan->staging.reset();
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanOutOfCore(hipfftHandle plan, int enable)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    plan->out_of_core = bool(enable);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanTrimWorkBuffer(hipfftHandle plan)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+
+    // the next execution allocates a new one
+    hipfft_plan_lock lock(plan);
+    return hipfftFreeWorkBuffer(plan);
+}
+
+hipfftResult hipfftExtWorkBufferPoolTrim()
+{
+    hipfft_workbuffer_pool::get().trim();
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtWorkBufferPoolGetStats(hipfftExtWorkBufferPoolStats* stats)
+{
+    if(!stats)
+        return HIPFFT_INVALID_VALUE;
+    hipfft_workbuffer_pool::get().get_stats(*stats);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPinnedPoolSetLimit(size_t bytes)
+{
+    hipfft_pinned_pool::get().set_limit(bytes);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPinnedPoolTrim()
+{
+    hipfft_pinned_pool::get().trim();
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPinnedPoolGetStats(hipfftExtPinnedPoolStats* stats)
+{
+    if(!stats)
+        return HIPFFT_INVALID_VALUE;
+    hipfft_pinned_pool::get().get_stats(*stats);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtTrimMemory()
+{
+    return hipfftTrimIdleMemory();
+}
+
+hipfftResult hipfftExtSetMemoryPressureCallback(hipfftExtMemoryPressureCallback callback,
+                                                void*                           user_data)
+{
+    auto&                       pressure = hipfft_memory_pressure::get();
+    std::lock_guard<std::mutex> lock(pressure.mutex);
+    pressure.callback  = callback;
+    pressure.user_data = user_data;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtWorkAreaGroupCreate(hipfftExtWorkAreaGroup* group)
+{
+    if(!group)
+        return HIPFFT_INVALID_VALUE;
+    *group = new hipfftExtWorkAreaGroup_t;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtWorkAreaGroupAddPlan(hipfftExtWorkAreaGroup group, hipfftHandle plan)
+{
+    if(!group)
+        return HIPFFT_INVALID_VALUE;
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    if(plan->work_area_group == group)
+        return HIPFFT_SUCCESS;
+    // a work area the caller manages can't be replaced by the group's
+    if(plan->work_area_group || !plan->autoAllocate)
+        return HIPFFT_INVALID_VALUE;
+
+    // the group's buffer replaces whatever the plan was using
+    {
+        hipfft_plan_lock lock(plan);
+        hipfftFreeWorkBuffer(plan);
+    }
+
+    group->plans.push_back(plan);
+    plan->work_area_group = group;
+    return hipfftWorkAreaGroupUpdate(group, plan->workBufferSize);
+}
+
+hipfftResult hipfftExtWorkAreaGroupRemovePlan(hipfftExtWorkAreaGroup group, hipfftHandle plan)
+{
+    if(!group)
+        return HIPFFT_INVALID_VALUE;
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(plan->work_area_group != group)
+        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftWorkAreaGroupDetach(plan));
+
+    // the plan goes back to a work buffer of its own
+    if(plan->workBufferSize > 0)
+        HIP_FFT_CHECK_AND_RETURN(hipfftAllocWorkBuffer(plan, plan->workBufferSize));
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtWorkAreaGroupGetSize(hipfftExtWorkAreaGroup group, size_t* size)
+{
+    if(!group || !size)
+        return HIPFFT_INVALID_VALUE;
+    *size = group->size;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtWorkAreaGroupDestroy(hipfftExtWorkAreaGroup group)
+{
+    if(!group)
+        return HIPFFT_SUCCESS;
+
+    auto res = HIPFFT_SUCCESS;
+    for(auto member : group->plans)
+    {
+        member->work_area_group = nullptr;
+        if(res == HIPFFT_SUCCESS && member->workBufferSize > 0)
+            res = hipfftAllocWorkBuffer(member, member->workBufferSize);
+    }
+    if(group->buffer)
+        hipFree(group->buffer);
+    delete group;
+    return res;
+}
+
+hipfftResult hipfftExtPlanCacheSetCapacity(size_t capacity)
+{
+    hipfft_plan_cache::get().set_capacity(capacity);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanCacheClear()
+{
+    hipfft_plan_cache::get().clear();
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanCacheGetStats(hipfftExtPlanCacheStats* stats)
+{
+    if(!stats)
+        return HIPFFT_INVALID_VALUE;
+    hipfft_plan_cache::get().get_stats(*stats);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtExportWisdom(const char* path)
+{
+    if(!path)
+        return HIPFFT_INVALID_VALUE;
+
+    // rocFFT's kernel cache is only usable while rocFFT is set up
+    rocfft_init_once();
+
+    std::string wisdom;
+    HIP_FFT_CHECK_AND_RETURN(hipfft_wisdom::get().serialize(wisdom));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file.write(wisdom.data(), wisdom.size()))
+        return HIPFFT_INVALID_VALUE;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtImportWisdom(const char* path)
+{
+    if(!path)
+        return HIPFFT_INVALID_VALUE;
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+        return HIPFFT_INVALID_VALUE;
+    const std::string wisdom((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+
+    std::vector<std::pair<hipfft_wisdom::entry_key, size_t>> keys;
+    std::string                                               kernels;
+    HIP_FFT_CHECK_AND_RETURN(hipfft_wisdom::deserialize(wisdom, keys, kernels));
+
+    rocfft_init_once();
+    if(rocfft_cache_deserialize(kernels.data(), kernels.size()) != rocfft_status_success)
+        return HIPFFT_PARSE_ERROR;
+
+    // work buffer sizes only hold for the architecture they were
+    // recorded on, so plans for architectures that no device here
+    // has are skipped.  The rest aren't created until they're
+    // needed, which is quick with the kernels already compiled, so
+    // importing doesn't depend on the plan cache's capacity.
+    auto& registry = hipfft_wisdom::get();
+    int   count    = 0;
+    if(hipGetDeviceCount(&count) != hipSuccess)
+        return HIPFFT_INVALID_DEVICE;
+    std::vector<std::string> archs(count);
+    for(int device = 0; device < count; ++device)
+        if(!registry.device_arch(device, archs[device]))
+            return HIPFFT_INVALID_DEVICE;
+    // files list the most recently used plans first
+    for(auto k = keys.rbegin(); k != keys.rend(); ++k)
+    {
+        if(std::find(archs.begin(), archs.end(), k->first.first) != archs.end())
+            registry.record(k->first, k->second);
+    }
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult
+    hipfftMakePlan1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
+{
+
+    if(nx < 0 || batch < 0)
+    {
+        return HIPFFT_INVALID_SIZE;
+    }
+
+    size_t lengths[1];
+    lengths[0]                                      = nx;
+    size_t                     number_of_transforms = batch;
+    hipfft_plan_description_t* desc                 = nullptr;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlan_internal(
+        plan, 1, lengths, iotype, number_of_transforms, desc, workSize, false);
+}
+
+hipfftResult hipfftMakePlan2d(hipfftHandle plan, int nx, int ny, hipfftType type, size_t* workSize)
+{
+
+    if(nx < 0 || ny < 0)
+    {
+        return HIPFFT_INVALID_SIZE;
+    }
+
+    size_t lengths[2];
+    lengths[0]                                      = ny;
+    lengths[1]                                      = nx;
+    size_t                     number_of_transforms = 1;
+    hipfft_plan_description_t* desc                 = nullptr;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlan_internal(
+        plan, 2, lengths, iotype, number_of_transforms, desc, workSize, false);
+}
+
+hipfftResult
+    hipfftMakePlan3d(hipfftHandle plan, int nx, int ny, int nz, hipfftType type, size_t* workSize)
+{
+
+    if(nx < 0 || ny < 0 || nz < 0)
+    {
+        return HIPFFT_INVALID_SIZE;
+    }
+
+    size_t lengths[3];
+    lengths[0]                                      = nz;
+    lengths[1]                                      = ny;
+    lengths[2]                                      = nx;
+    size_t                     number_of_transforms = 1;
+    hipfft_plan_description_t* desc                 = nullptr;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlan_internal(
+        plan, 3, lengths, iotype, number_of_transforms, desc, workSize, false);
+}
+
+template <typename T>
+static hipfftResult hipfftMakePlanOutOfCore(hipfftHandle plan,
+                                            int          rank,
+                                            T*           n,
+                                            T*           inembed,
+                                            T*           onembed,
+                                            hipfftIOType type,
+                                            T            batch,
+                                            size_t*      workSize);
+
+template <typename T>
+hipfftResult hipfftMakePlanMany_internal(hipfftHandle plan,
+                                         int          rank,
+                                         T*           n,
+                                         T*           inembed,
+                                         T            istride,
+                                         T            idist,
+                                         T*           onembed,
+                                         T            ostride,
+                                         T            odist,
+                                         hipfftIOType type,
+                                         T            batch,
+                                         size_t*      workSize)
+{
+    if((inembed != nullptr && onembed == nullptr) || (inembed == nullptr && onembed != nullptr)
+       || (rank < 0) || (istride < 0) || (idist < 0) || (ostride < 0) || (odist < 0)
+       || (std::any_of(n, n + rank, [](T val) { return val < 0; })))
+        return HIPFFT_INVALID_VALUE;
+
+    for(auto ptr : {inembed, onembed})
+    {
+        if(ptr == nullptr)
+            continue;
+        if(std::any_of(ptr, ptr + rank, [](T val) { return val < 0; }))
+            return HIPFFT_INVALID_SIZE;
+    }
+
+    if(batch < 0)
+        return HIPFFT_INVALID_SIZE;
+
+    if(plan->out_of_core)
+        return hipfftMakePlanOutOfCore(plan, rank, n, inembed, onembed, type, batch, workSize);
+
+    size_t lengths[3];
+    for(int i = 0; i < rank; i++)
+        lengths[i] = n[rank - 1 - i];
+
+    size_t number_of_transforms = batch;
+
+    // Decide the inArrayType and outArrayType based on the transform type
+    rocfft_array_type in_array_type, out_array_type;
+    if(type.is_real_to_complex())
+    {
+        in_array_type  = rocfft_array_type_real;
+        out_array_type = rocfft_array_type_hermitian_interleaved;
+    }
+    else if(type.is_complex_to_real())
+    {
+        in_array_type  = rocfft_array_type_hermitian_interleaved;
+        out_array_type = rocfft_array_type_real;
+    }
+    else
+    {
+        in_array_type  = rocfft_array_type_complex_interleaved;
+        out_array_type = rocfft_array_type_complex_interleaved;
+    }
+
+    hipfft_plan_description_t desc;
+
+    bool re_calc_strides_in_desc = (inembed == nullptr) || (onembed == nullptr);
+
+    size_t i_strides[3] = {1, 1, 1};
+    size_t o_strides[3] = {1, 1, 1};
+    for(int i = 1; i < rank; i++)
+    {
+        i_strides[i] = lengths[i - 1] * i_strides[i - 1];
+        o_strides[i] = lengths[i - 1] * o_strides[i - 1];
+    }
+
+    if(inembed != nullptr)
+    {
+        i_strides[0] = istride;
+
+        size_t inembed_lengths[3];
+        for(int i = 0; i < rank; i++)
+            inembed_lengths[i] = inembed[rank - 1 - i];
+
+        for(int i = 1; i < rank; i++)
+            i_strides[i] = inembed_lengths[i - 1] * i_strides[i - 1];
+    }
+
+    if(onembed != nullptr)
+    {
+        o_strides[0] = ostride;
+
+        size_t onembed_lengths[3];
+        for(int i = 0; i < rank; i++)
+            onembed_lengths[i] = onembed[rank - 1 - i];
+
+        for(int i = 1; i < rank; i++)
+            o_strides[i] = onembed_lengths[i - 1] * o_strides[i - 1];
+    }
+
+    desc.inArrayType  = in_array_type;
+    desc.outArrayType = out_array_type;
+
+    for(int i = 0; i < rank; i++)
+        desc.inStrides[i] = i_strides[i];
+    desc.inDist = idist;
+
+    for(int i = 0; i < rank; i++)
+        desc.outStrides[i] = o_strides[i];
+    desc.outDist = odist;
+
+    hipfftResult ret = hipfftMakePlan_internal(
+        plan, rank, lengths, type, number_of_transforms, &desc, workSize, re_calc_strides_in_desc);
+
+    return ret;
+}
+
+hipfftResult hipfftMakePlanMany(hipfftHandle plan,
+                                int          rank,
+                                int*         n,
+                                int*         inembed,
+                                int          istride,
+                                int          idist,
+                                int*         onembed,
+                                int          ostride,
+                                int          odist,
+                                hipfftType   type,
+                                int          batch,
+                                size_t*      workSize)
+{
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlanMany_internal<int>(
+        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
+}
+
+hipfftResult hipfftMakePlanMany64(hipfftHandle   plan,
+                                  int            rank,
+                                  long long int* n,
+                                  long long int* inembed,
+                                  long long int  istride,
+                                  long long int  idist,
+                                  long long int* onembed,
+                                  long long int  ostride,
+                                  long long int  odist,
+                                  hipfftType     type,
+                                  long long int  batch,
+                                  size_t*        workSize)
 {
-    if(!std::isfinite(scalefactor))
-        return HIPFFT_INVALID_VALUE;
-    plan->scale_factor = scalefactor;
-    return HIPFFT_SUCCESS;
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+
+    return hipfftMakePlanMany_internal<long long int>(
+        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
 }
 
-hipfftResult
-    hipfftMakePlan1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
+// Size queries go through the regular plan creation path on a
+// temporary handle that never allocates a work buffer or execution
+// info.  Its sub-plans only work out their sizes, without adding
+// plans to the plan cache (see hipfftCreateSubplan).  Settings on
+// the caller's handle (if any) that affect the work area size are
+// honoured, but the handle itself is left alone.
+static void hipfftInitSizeQuery(hipfftHandle_t& query, const hipfftHandle plan)
 {
-
-    if(nx < 0 || batch < 0)
+    if(plan)
     {
-        return HIPFFT_INVALID_SIZE;
+        query.scale_factor    = plan->scale_factor;
+        query.dynamic_scales  = plan->dynamic_scales;
+        query.placement_hints = plan->placement_hints;
+        query.direction_hints = plan->direction_hints;
+        query.memory_limit    = plan->memory_limit;
+        query.out_of_core     = plan->out_of_core;
     }
+    query.autoAllocate = false;
+    query.size_query   = true;
+}
 
-    size_t lengths[1];
-    lengths[0]                                      = nx;
-    size_t                     number_of_transforms = batch;
-    hipfft_plan_description_t* desc                 = nullptr;
+hipfftResult hipfftEstimate1d(int nx, hipfftType type, int batch, size_t* workSize)
+{
+    hipfftHandle plan = nullptr;
+    hipfftResult ret  = hipfftGetSize1d(plan, nx, type, batch, workSize);
+    return ret;
+}
 
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+hipfftResult hipfftEstimate2d(int nx, int ny, hipfftType type, size_t* workSize)
+{
+    hipfftHandle plan = nullptr;
+    hipfftResult ret  = hipfftGetSize2d(plan, nx, ny, type, workSize);
+    return ret;
+}
 
-    return hipfftMakePlan_internal(
-        plan, 1, lengths, iotype, number_of_transforms, desc, workSize, false);
+hipfftResult hipfftEstimate3d(int nx, int ny, int nz, hipfftType type, size_t* workSize)
+{
+    hipfftHandle plan = nullptr;
+    hipfftResult ret  = hipfftGetSize3d(plan, nx, ny, nz, type, workSize);
+    return ret;
 }
 
-hipfftResult hipfftMakePlan2d(hipfftHandle plan, int nx, int ny, hipfftType type, size_t* workSize)
+hipfftResult hipfftEstimateMany(int        rank,
+                                int*       n,
+                                int*       inembed,
+                                int        istride,
+                                int        idist,
+                                int*       onembed,
+                                int        ostride,
+                                int        odist,
+                                hipfftType type,
+                                int        batch,
+                                size_t*    workSize)
 {
+    hipfftHandle plan = nullptr;
+    hipfftResult ret  = hipfftGetSizeMany(
+        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, workSize);
+    return ret;
+}
 
-    if(nx < 0 || ny < 0)
+hipfftResult
+    hipfftGetSize1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
+{
+
+    if(nx < 0 || batch < 0)
     {
         return HIPFFT_INVALID_SIZE;
     }
 
-    size_t lengths[2];
-    lengths[0]                                      = ny;
-    lengths[1]                                      = nx;
-    size_t                     number_of_transforms = 1;
-    hipfft_plan_description_t* desc                 = nullptr;
+    hipfftHandle_t query;
+    hipfftInitSizeQuery(query, plan);
+    return hipfftMakePlan1d(&query, nx, type, batch, workSize);
+}
 
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+hipfftResult hipfftGetSize2d(hipfftHandle plan, int nx, int ny, hipfftType type, size_t* workSize)
+{
+    if(nx < 0 || ny < 0)
+    {
+        return HIPFFT_INVALID_SIZE;
+    }
 
-    return hipfftMakePlan_internal(
-        plan, 2, lengths, iotype, number_of_transforms, desc, workSize, false);
+    hipfftHandle_t query;
+    hipfftInitSizeQuery(query, plan);
+    return hipfftMakePlan2d(&query, nx, ny, type, workSize);
 }
 
 hipfftResult
-    hipfftMakePlan3d(hipfftHandle plan, int nx, int ny, int nz, hipfftType type, size_t* workSize)
+    hipfftGetSize3d(hipfftHandle plan, int nx, int ny, int nz, hipfftType type, size_t* workSize)
 {
-
     if(nx < 0 || ny < 0 || nz < 0)
     {
         return HIPFFT_INVALID_SIZE;
     }
 
-    size_t lengths[3];
-    lengths[0]                                      = nz;
-    lengths[1]                                      = ny;
-    lengths[2]                                      = nx;
-    size_t                     number_of_transforms = 1;
-    hipfft_plan_description_t* desc                 = nullptr;
+    hipfftHandle_t query;
+    hipfftInitSizeQuery(query, plan);
+    return hipfftMakePlan3d(&query, nx, ny, nz, type, workSize);
+}
 
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+hipfftResult hipfftGetSizeMany(hipfftHandle plan,
+                               int          rank,
+                               int*         n,
+                               int*         inembed,
+                               int          istride,
+                               int          idist,
+                               int*         onembed,
+                               int          ostride,
+                               int          odist,
+                               hipfftType   type,
+                               int          batch,
+                               size_t*      workSize)
+{
+    hipfftHandle_t query;
+    hipfftInitSizeQuery(query, plan);
+    return hipfftMakePlanMany(
+        &query, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, workSize);
+}
 
-    return hipfftMakePlan_internal(
-        plan, 3, lengths, iotype, number_of_transforms, desc, workSize, false);
+hipfftResult hipfftGetSizeMany64(hipfftHandle   plan,
+                                 int            rank,
+                                 long long int* n,
+                                 long long int* inembed,
+                                 long long int  istride,
+                                 long long int  idist,
+                                 long long int* onembed,
+                                 long long int  ostride,
+                                 long long int  odist,
+                                 hipfftType     type,
+                                 long long int  batch,
+                                 size_t*        workSize)
+{
+    hipfftHandle_t query;
+    hipfftInitSizeQuery(query, plan);
+    return hipfftMakePlanMany64(
+        &query, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, workSize);
 }
 
-template <typename T>
-hipfftResult hipfftMakePlanMany_internal(hipfftHandle plan,
-                                         int          rank,
-                                         T*           n,
-                                         T*           inembed,
-                                         T            istride,
-                                         T            idist,
-                                         T*           onembed,
-                                         T            ostride,
-                                         T            odist,
-                                         hipfftIOType type,
-                                         T            batch,
-                                         size_t*      workSize)
+hipfftResult hipfftGetSize(hipfftHandle plan, size_t* workSize)
 {
-    if((inembed != nullptr && onembed == nullptr) || (inembed == nullptr && onembed != nullptr)
-       || (rank < 0) || (istride < 0) || (idist < 0) || (ostride < 0) || (odist < 0)
-       || (std::any_of(n, n + rank, [](T val) { return val < 0; })))
-        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    *workSize = plan->workBufferSize;
+    return HIPFFT_SUCCESS;
+}
 
-    for(auto ptr : {inembed, onembed})
+hipfftResult hipfftSetAutoAllocation(hipfftHandle plan, int autoAllocate)
+{
+    if(plan != nullptr)
+        plan->autoAllocate = bool(autoAllocate);
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftSetWorkArea(hipfftHandle plan, void* workArea)
+{
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    // a caller-provided work area replaces the group's
+    HIP_FFT_CHECK_AND_RETURN(hipfftWorkAreaGroupDetach(plan));
+    hipfft_plan_lock lock(plan);
+    hipfftFreeWorkBuffer(plan);
+    plan->workBuffer = workArea;
+    if(workArea)
     {
-        if(ptr == nullptr)
-            continue;
-        if(std::any_of(ptr, ptr + rank, [](T val) { return val < 0; }))
-            return HIPFFT_INVALID_SIZE;
+        ROC_FFT_CHECK_INVALID_VALUE(
+            hipfftSetInfoWorkBuffer(plan, workArea, plan->workBufferSize));
     }
+    return HIPFFT_SUCCESS;
+}
 
-    if(batch < 0)
-        return HIPFFT_INVALID_SIZE;
+// Make sure the plan's work buffer is big enough for a sub-plan
+// created after the plan was initialized
+static hipfftResult hipfftReserveWorkBuffer(hipfftHandle plan, size_t workBufferSize)
+{
+    if(workBufferSize <= plan->workBufferSize)
+        return HIPFFT_SUCCESS;
+    plan->workBufferSize = workBufferSize;
 
-    size_t lengths[3];
-    for(int i = 0; i < rank; i++)
-        lengths[i] = n[rank - 1 - i];
+    // a user-provided work area is too small now - the caller needs
+    // to query the new size and provide a bigger one
+    if(!plan->autoAllocate)
+        return HIPFFT_NO_WORKSPACE;
+    return hipfftGrowWorkBuffer(plan, workBufferSize);
+}
 
-    size_t number_of_transforms = batch;
+// Find the specific plan to execute - check placement and direction.
+// Lazy sub-plans are created here on first use, growing the work
+// buffer if they need more than what's been allocated so far.
+static hipfftResult get_exec_plan(hipfftHandle           plan,
+                                  const bool             inplace,
+                                  const int              direction,
+                                  const hipfft_subplan*& exec_subplan)
+{
+    exec_subplan = nullptr;
+    // a plan that's still being created is waited for
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
 
-    // Decide the inArrayType and outArrayType based on the transform type
-    rocfft_array_type in_array_type, out_array_type;
-    if(type.is_real_to_complex())
+    hipfft_subplan* subplan = nullptr;
+    switch(direction)
     {
-        in_array_type  = rocfft_array_type_real;
-        out_array_type = rocfft_array_type_hermitian_interleaved;
+    case HIPFFT_FORWARD:
+        subplan = inplace ? &plan->ip_forward : &plan->op_forward;
+        break;
+    case HIPFFT_BACKWARD:
+        subplan = inplace ? &plan->ip_inverse : &plan->op_inverse;
+        break;
     }
-    else if(type.is_complex_to_real())
+    if(!subplan)
+        return HIPFFT_SUCCESS;
+
+    if(!subplan->attempted)
     {
-        in_array_type  = rocfft_array_type_hermitian_interleaved;
-        out_array_type = rocfft_array_type_real;
+        size_t workBufferSize = 0;
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplan(*subplan, workBufferSize));
+        plan->build_seconds += subplan->build_seconds;
+        HIP_FFT_CHECK_AND_RETURN(hipfftReserveWorkBuffer(plan, workBufferSize));
     }
-    else
+    exec_subplan = subplan;
+    return HIPFFT_SUCCESS;
+}
+
+// Prefetch a managed buffer to the given device, ordered on the
+// plan's stream.  Other kinds of memory are left alone.
+static hipfftResult
+    hipfftPrefetchIfManaged(hipfftHandle plan, const void* ptr, size_t bytes, int device)
+{
+    hipPointerAttribute_t attr;
+    if(hipPointerGetAttributes(&attr, ptr) != hipSuccess)
     {
-        in_array_type  = rocfft_array_type_complex_interleaved;
-        out_array_type = rocfft_array_type_complex_interleaved;
+        // ordinary host memory is unknown to HIP, which isn't an
+        // error worth keeping around
+        (void)hipGetLastError();
+        return HIPFFT_SUCCESS;
+    }
+    if(!attr.isManaged || bytes == 0)
+        return HIPFFT_SUCCESS;
+
+    if(hipMemPrefetchAsync(ptr, bytes, device, plan->stream) != hipSuccess)
+        return HIPFFT_EXEC_FAILED;
+    plan->prefetch_bytes += bytes;
+    ++plan->prefetches;
+    return HIPFFT_SUCCESS;
+}
+
+enum class hipfft_memory_kind
+{
+    device,
+    pinned,
+    pageable,
+};
+
+// What kind of memory a pointer is to, as far as copies are
+// concerned.  Memory the device can access directly counts as
+// device memory.
+static hipfft_memory_kind hipfftMemoryKind(const void* ptr)
+{
+    hipPointerAttribute_t attr;
+    if(hipPointerGetAttributes(&attr, ptr) != hipSuccess)
+    {
+        // older HIP reports ordinary pageable memory as an error
+        (void)hipGetLastError();
+        return hipfft_memory_kind::pageable;
+    }
+    switch(attr.type)
+    {
+    case hipMemoryTypeDevice:
+    case hipMemoryTypeManaged:
+    case hipMemoryTypeArray:
+    case hipMemoryTypeUnified:
+        return hipfft_memory_kind::device;
+    case hipMemoryTypeHost:
+        return attr.isManaged ? hipfft_memory_kind::device : hipfft_memory_kind::pinned;
+    default:
+        // including hipMemoryTypeUnregistered, which newer HIP
+        // reports for pageable memory
+        return hipfft_memory_kind::pageable;
     }
+}
 
-    hipfft_plan_description_t desc;
+// Copies between host memory and a plan's device staging buffers.
+// Copies of pageable memory are bounced through buffers from the
+// pinned pool: the host copies between the pageable memory and the
+// pinned buffer, and the device copies the pinned buffer.
+//
+// A copy to the host is only complete once finish() has been called
+// for its stream.
+class hipfft_host_copies
+{
+public:
+    hipfft_host_copies() = default;
+    ~hipfft_host_copies()
+    {
+        finish_all();
+    }
+    hipfft_host_copies(const hipfft_host_copies&) = delete;
+    hipfft_host_copies& operator=(const hipfft_host_copies&) = delete;
+
+    // Copy rows of width bytes, pitch bytes apart on the host, to
+    // contiguous device memory
+    hipfftResult to_device(void*              dst,
+                           const void*        src,
+                           size_t             pitch,
+                           size_t             width,
+                           size_t             rows,
+                           hipfft_memory_kind kind,
+                           hipStream_t        stream)
+    {
+        hipfft_pinned_pool::block block;
+        if(!bounce(kind, width * rows, block))
+            return hipMemcpy2DAsync(
+                       dst, width, src, pitch, width, rows, hipMemcpyDefault, stream)
+                           == hipSuccess
+                       ? HIPFFT_SUCCESS
+                       : HIPFFT_EXEC_FAILED;
+
+        auto packed = static_cast<char*>(block.ptr);
+        for(size_t r = 0; r < rows; ++r)
+            std::memcpy(packed + r * width, static_cast<const char*>(src) + r * pitch, width);
+        const auto ret = hipMemcpyAsync(dst, packed, width * rows, hipMemcpyHostToDevice, stream);
+        hipfft_pinned_pool::get().release(block, stream);
+        return ret == hipSuccess ? HIPFFT_SUCCESS : HIPFFT_EXEC_FAILED;
+    }
 
-    bool re_calc_strides_in_desc = (inembed == nullptr) || (onembed == nullptr);
+    // Copy contiguous device memory to rows of width bytes, pitch
+    // bytes apart on the host
+    hipfftResult to_host(void*              dst,
+                         size_t             pitch,
+                         const void*        src,
+                         size_t             width,
+                         size_t             rows,
+                         hipfft_memory_kind kind,
+                         hipStream_t        stream)
+    {
+        hipfft_pinned_pool::block block;
+        if(!bounce(kind, width * rows, block))
+            return hipMemcpy2DAsync(
+                       dst, pitch, src, width, width, rows, hipMemcpyDefault, stream)
+                           == hipSuccess
+                       ? HIPFFT_SUCCESS
+                       : HIPFFT_EXEC_FAILED;
+
+        pending.push_back({block, static_cast<char*>(dst), pitch, width, rows, stream});
+        if(hipMemcpyAsync(block.ptr, src, width * rows, hipMemcpyDeviceToHost, stream)
+           != hipSuccess)
+            return HIPFFT_EXEC_FAILED;
+        return HIPFFT_SUCCESS;
+    }
+
+    // Wait for the stream, and complete its copies to the host
+    hipfftResult finish(hipStream_t stream)
+    {
+        if(hipStreamSynchronize(stream) != hipSuccess)
+            return HIPFFT_EXEC_FAILED;
+        for(auto it = pending.begin(); it != pending.end();)
+        {
+            if(it->stream != stream)
+            {
+                ++it;
+                continue;
+            }
+            auto packed = static_cast<const char*>(it->block.ptr);
+            for(size_t r = 0; r < it->rows; ++r)
+                std::memcpy(it->dst + r * it->pitch, packed + r * it->width, it->width);
+            hipfft_pinned_pool::get().release(it->block, stream);
+            it = pending.erase(it);
+        }
+        return HIPFFT_SUCCESS;
+    }
 
-    size_t i_strides[3] = {1, 1, 1};
-    size_t o_strides[3] = {1, 1, 1};
-    for(int i = 1; i < rank; i++)
+    hipfftResult finish_all()
     {
-        i_strides[i] = lengths[i - 1] * i_strides[i - 1];
-        o_strides[i] = lengths[i - 1] * o_strides[i - 1];
+        hipfftResult ret = HIPFFT_SUCCESS;
+        while(!pending.empty())
+        {
+            const auto status = finish(pending.front().stream);
+            if(status != HIPFFT_SUCCESS)
+            {
+                // give the buffers back even if the copies failed
+                for(auto& p : pending)
+                    hipfft_pinned_pool::get().release(p.block, p.stream);
+                pending.clear();
+                ret = status;
+            }
+        }
+        return ret;
     }
 
-    if(inembed != nullptr)
+private:
+    // Borrow a pinned buffer to bounce a copy of pageable memory
+    // through, or return false to copy directly
+    static bool bounce(hipfft_memory_kind kind, size_t bytes, hipfft_pinned_pool::block& block)
     {
-        i_strides[0] = istride;
-
-        size_t inembed_lengths[3];
-        for(int i = 0; i < rank; i++)
-            inembed_lengths[i] = inembed[rank - 1 - i];
-
-        for(int i = 1; i < rank; i++)
-            i_strides[i] = inembed_lengths[i - 1] * i_strides[i - 1];
+        if(kind != hipfft_memory_kind::pageable)
+            return false;
+        if(hipfft_pinned_pool::get().acquire(bytes, block) == HIPFFT_SUCCESS)
+            return true;
+        hipfft_pinned_pool::get().count_fallback();
+        return false;
     }
 
-    if(onembed != nullptr)
+    struct copy
     {
-        o_strides[0] = ostride;
-
-        size_t onembed_lengths[3];
-        for(int i = 0; i < rank; i++)
-            onembed_lengths[i] = onembed[rank - 1 - i];
+        hipfft_pinned_pool::block block;
+        char*                     dst;
+        size_t                    pitch;
+        size_t                    width;
+        size_t                    rows;
+        hipStream_t               stream;
+    };
+    std::list<copy> pending;
+};
 
-        for(int i = 1; i < rank; i++)
-            o_strides[i] = onembed_lengths[i - 1] * o_strides[i - 1];
+// Execute a plan on data of which at least one side is in host
+// memory.  The batch is split into chunks that rotate through the
+// plan's staging slots: each slot copies its chunk in, transforms
+// it, and copies it out on its own stream, so one chunk's copies
+// overlap with other chunks' transforms.
+//
+// Pageable memory is copied through pinned buffers.  Output copied
+// that way is only complete once the host has copied it out of the
+// pinned buffer, so such executions wait for their last chunks.
+static hipfftResult hipfftExecStaged(const hipfftHandle    plan,
+                                     const hipfft_subplan* subplan,
+                                     void*                 idata,
+                                     void*                 odata,
+                                     hipfft_memory_kind    in_kind,
+                                     hipfft_memory_kind    out_kind)
+{
+    const bool   inplace  = idata == odata;
+    const bool   host_in  = in_kind != hipfft_memory_kind::device;
+    const bool   host_out = out_kind != hipfft_memory_kind::device;
+    const size_t batch
+        = std::max(subplan->total_transforms, subplan->key.number_of_transforms);
+    const size_t depth = plan->staging_depth;
+    const size_t chunk = plan->staging_chunk
+                             ? std::min(plan->staging_chunk, batch)
+                             : std::max<size_t>(1, (batch + 2 * depth - 1) / (2 * depth));
+
+    // plans for a full chunk and for whatever is left at the end
+    rocfft_plan_ptr chunk_plans[2];
+    size_t          work_size = 0;
+    for(size_t i = 0; i < 2; ++i)
+    {
+        const size_t count = i == 0 ? chunk : batch % chunk;
+        if(count == 0)
+            continue;
+        auto key                 = subplan->key;
+        key.number_of_transforms = count;
+        HIP_FFT_CHECK_AND_RETURN(hipfft_plan_cache::get().find_or_create(key, chunk_plans[i]));
+        if(!chunk_plans[i])
+            return HIPFFT_EXEC_FAILED;
+        size_t size = 0;
+        ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_get_work_buffer_size(chunk_plans[i].get(), &size));
+        work_size = std::max(work_size, size);
     }
 
-    desc.inArrayType  = in_array_type;
-    desc.outArrayType = out_array_type;
+    size_t in_dist = 0, out_dist = 0, in_span = 0, out_span = 0;
+    subplan->key.batch_distances(in_dist, out_dist);
+    subplan->key.buffer_bytes(chunk, in_span, out_span);
 
-    for(int i = 0; i < rank; i++)
-        desc.inStrides[i] = i_strides[i];
-    desc.inDist = idist;
+    if(!plan->staging)
+        plan->staging = std::make_unique<hipfft_host_staging>();
+    auto& staging = *plan->staging;
+    HIP_FFT_CHECK_AND_RETURN(staging.prepare(depth, in_span, out_span, work_size, inplace));
 
-    for(int i = 0; i < rank; i++)
-        desc.outStrides[i] = o_strides[i];
-    desc.outDist = odist;
+    // slots start once earlier work on the plan's stream is done.
+    // Pageable input is read by the host, which has to wait too.
+    if(hipEventRecord(staging.ready, plan->stream) != hipSuccess)
+        return HIPFFT_EXEC_FAILED;
+    if(in_kind == hipfft_memory_kind::pageable && hipEventSynchronize(staging.ready) != hipSuccess)
+        return HIPFFT_EXEC_FAILED;
+    for(size_t i = 0; i < std::min(depth, (batch + chunk - 1) / chunk); ++i)
+    {
+        auto& s = staging.slots[i];
+        if(hipStreamWaitEvent(s.stream, staging.ready, 0) != hipSuccess)
+            return HIPFFT_EXEC_FAILED;
+        if(rocfft_execution_info_set_load_callback(s.info,
+                                                   plan->load_callback_ptrs,
+                                                   plan->load_callback_data,
+                                                   plan->load_callback_lds_bytes)
+               != rocfft_status_success
+           || rocfft_execution_info_set_store_callback(s.info,
+                                                       plan->store_callback_ptrs,
+                                                       plan->store_callback_data,
+                                                       plan->store_callback_lds_bytes)
+                  != rocfft_status_success)
+            return HIPFFT_EXEC_FAILED;
+    }
 
-    hipfftResult ret = hipfftMakePlan_internal(
-        plan, rank, lengths, type, number_of_transforms, &desc, workSize, re_calc_strides_in_desc);
+    hipfft_host_copies copies;
+    size_t             used = 0;
+    for(size_t done = 0, k = 0; done < batch; done += chunk, ++k)
+    {
+        auto&        s     = staging.slots[k % depth];
+        const size_t count = std::min(chunk, batch - done);
+        size_t       in_bytes = 0, out_bytes = 0;
+        subplan->key.buffer_bytes(count, in_bytes, out_bytes);
+
+        char* in_ptr  = static_cast<char*>(idata) + done * in_dist;
+        char* out_ptr = static_cast<char*>(odata) + done * out_dist;
+        void* dev_in  = host_in ? s.in : in_ptr;
+        void* dev_out = inplace ? dev_in : host_out ? s.out : out_ptr;
+
+        // finish the slot's last chunk before reusing it, to give its
+        // pinned buffer back
+        if(k >= depth && out_kind == hipfft_memory_kind::pageable)
+            HIP_FFT_CHECK_AND_RETURN(copies.finish(s.stream));
+
+        // in-place data is copied in whole, so that data between
+        // transforms is preserved on the way back out
+        if(inplace)
+            in_bytes = out_bytes = std::max(in_bytes, out_bytes);
+        if(host_in)
+            HIP_FFT_CHECK_AND_RETURN(
+                copies.to_device(dev_in, in_ptr, in_bytes, in_bytes, 1, in_kind, s.stream));
+
+        void* in[1]  = {dev_in};
+        void* out[1] = {dev_out};
+        const auto rplan = count == chunk ? chunk_plans[0].get() : chunk_plans[1].get();
+        if(rocfft_execute(rplan, in, out, s.info) != rocfft_status_success)
+            return HIPFFT_EXEC_FAILED;
+
+        if(host_out)
+            HIP_FFT_CHECK_AND_RETURN(
+                copies.to_host(out_ptr, out_bytes, dev_out, out_bytes, 1, out_kind, s.stream));
+        used = std::max(used, k % depth + 1);
+    }
+    HIP_FFT_CHECK_AND_RETURN(copies.finish_all());
 
-    return ret;
+    // later work on the plan's stream waits for all of the chunks
+    for(size_t i = 0; i < used; ++i)
+    {
+        auto& s = staging.slots[i];
+        if(hipEventRecord(s.done, s.stream) != hipSuccess
+           || hipStreamWaitEvent(plan->stream, s.done, 0) != hipSuccess)
+            return HIPFFT_EXEC_FAILED;
+    }
+    return HIPFFT_SUCCESS;
 }
 
-hipfftResult hipfftMakePlanMany(hipfftHandle plan,
-                                int          rank,
-                                int*         n,
-                                int*         inembed,
-                                int          istride,
-                                int          idist,
-                                int*         onembed,
-                                int          ostride,
-                                int          odist,
-                                hipfftType   type,
-                                int          batch,
-                                size_t*      workSize)
+// Whether executions of a sub-plan split its batch across the plan's
+// streams.  Batches already split for a memory limit stay on one
+// stream, and so do plans with callbacks, which would see offsets
+// relative to each partition.
+static bool hipfftSplitsBatch(hipfftHandle plan, const hipfft_subplan* subplan)
 {
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
-
-    return hipfftMakePlanMany_internal<int>(
-        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
+    return plan->stream_set && subplan->key.number_of_transforms > 1
+           && subplan->total_transforms <= subplan->key.number_of_transforms
+           && !plan->load_callback_ptrs && !plan->store_callback_ptrs;
 }
 
-hipfftResult hipfftMakePlanMany64(hipfftHandle   plan,
-                                  int            rank,
-                                  long long int* n,
-                                  long long int* inembed,
-                                  long long int  istride,
-                                  long long int  idist,
-                                  long long int* onembed,
-                                  long long int  ostride,
-                                  long long int  odist,
-                                  hipfftType     type,
-                                  long long int  batch,
-                                  size_t*        workSize)
+// Find the plans for a split execution's full partitions and its
+// smaller last one, and point the partitions at slices of the plan's
+// work area.  An automatically-allocated work area that's too small
+// is grown, which a capture can't do since it frees the old one.
+static hipfftResult hipfftReservePartitions(const hipfftHandle    plan,
+                                            const hipfft_subplan* subplan,
+                                            size_t                batch,
+                                            bool                  captured,
+                                            rocfft_plan_ptr (&part_plans)[2],
+                                            size_t& chunk)
 {
-    hipfftIOType iotype;
-    HIP_FFT_CHECK_AND_RETURN(iotype.init(type));
+    auto&        set    = *plan->stream_set;
+    const size_t nparts = std::min(set.parts.size(), batch);
+    chunk               = (batch + nparts - 1) / nparts;
 
-    return hipfftMakePlanMany_internal<long long int>(
-        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
-}
+    size_t slice_size = 0;
+    for(size_t i = 0; i < 2; ++i)
+    {
+        const size_t count = i == 0 ? chunk : batch % chunk;
+        if(count == 0)
+            continue;
+        auto key                 = subplan->key;
+        key.number_of_transforms = count;
+        HIP_FFT_CHECK_AND_RETURN(hipfft_plan_cache::get().find_or_create(key, part_plans[i]));
+        if(!part_plans[i])
+            return HIPFFT_EXEC_FAILED;
+        size_t size = 0;
+        ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_get_work_buffer_size(part_plans[i].get(), &size));
+        slice_size = std::max(slice_size, size);
+    }
+    if(slice_size == 0)
+        return HIPFFT_SUCCESS;
+    slice_size          = (slice_size + 255) / 256 * 256;
+    const size_t needed = slice_size * nparts;
+
+    const auto group = plan->work_area_group;
+    void*      area  = group ? group->buffer : plan->workBuffer;
+    size_t     size  = 0;
+    if(group)
+        size = group->size;
+    else if(plan->workBuffer)
+        size = plan->workBufferNeedsFree ? plan->workBufferAllocSize : plan->workBufferSize;
+    if(needed > size)
+    {
+        // like a lazy sub-plan, a user-provided work area is too small
+        // now - the caller needs to query the new size and provide a
+        // bigger one
+        plan->workBufferSize = std::max(plan->workBufferSize, needed);
+        if(!plan->autoAllocate)
+            return HIPFFT_NO_WORKSPACE;
+        if(captured)
+            return HIPFFT_NOT_SUPPORTED;
+
+        // plans that would borrow a work buffer get one of their own,
+        // since the partitions' infos keep pointing at it
+        if(group)
+        {
+            HIP_FFT_CHECK_AND_RETURN(hipfftWorkAreaGroupUpdate(group, plan->workBufferSize));
+        }
+        else
+        {
+            HIP_FFT_CHECK_AND_RETURN(hipfftFreeWorkBuffer(plan));
+            HIP_FFT_CHECK_AND_RETURN(
+                hipfftAllocWorkBufferNow(plan, plan->workBufferSize, false));
+        }
+        area = group ? group->buffer : plan->workBuffer;
+    }
 
-hipfftResult hipfftEstimate1d(int nx, hipfftType type, int batch, size_t* workSize)
-{
-    hipfftHandle plan = nullptr;
-    hipfftResult ret  = hipfftGetSize1d(plan, nx, type, batch, workSize);
-    return ret;
+    // graphs captured with the old slices can't be launched any more.
+    // A capture in progress has its new entry keyed on the new ones.
+    if(area != set.work && !captured)
+        plan->graphs.reset();
+    return set.use_work(area, slice_size);
 }
 
-hipfftResult hipfftEstimate2d(int nx, int ny, hipfftType type, size_t* workSize)
+// Execute a plan with its batch split evenly across the plan's
+// streams.  Partitions on streams other than the plan's own start
+// after earlier work on the plan's stream, and later work on it
+// waits for them.
+static hipfftResult hipfftExecPartitioned(const hipfftHandle    plan,
+                                          const hipfft_subplan* subplan,
+                                          void*                 idata,
+                                          void*                 odata,
+                                          size_t                batch,
+                                          bool                  captured)
 {
-    hipfftHandle plan = nullptr;
-    hipfftResult ret  = hipfftGetSize2d(plan, nx, ny, type, workSize);
-    return ret;
-}
+    auto&           set = *plan->stream_set;
+    rocfft_plan_ptr part_plans[2];
+    size_t          chunk = 0;
+    HIP_FFT_CHECK_AND_RETURN(
+        hipfftReservePartitions(plan, subplan, batch, captured, part_plans, chunk));
 
-hipfftResult hipfftEstimate3d(int nx, int ny, int nz, hipfftType type, size_t* workSize)
-{
-    hipfftHandle plan = nullptr;
-    hipfftResult ret  = hipfftGetSize3d(plan, nx, ny, nz, type, workSize);
-    return ret;
+    size_t in_dist = 0, out_dist = 0;
+    subplan->key.batch_distances(in_dist, out_dist);
+
+    if(hipEventRecord(set.start, plan->stream) != hipSuccess)
+        return HIPFFT_EXEC_FAILED;
+    for(size_t done = 0, i = 0; done < batch; done += chunk, ++i)
+    {
+        auto&        p      = set.parts[i];
+        const size_t count  = std::min(chunk, batch - done);
+        const bool   joined = p.stream != plan->stream;
+        if(joined && hipStreamWaitEvent(p.stream, set.start, 0) != hipSuccess)
+            return HIPFFT_EXEC_FAILED;
+
+        void*      in[1]  = {static_cast<char*>(idata) + done * in_dist};
+        void*      out[1] = {static_cast<char*>(odata) + done * out_dist};
+        const auto rplan  = count == chunk ? part_plans[0].get() : part_plans[1].get();
+        if(rocfft_execute(rplan, in, out, p.info) != rocfft_status_success)
+            return HIPFFT_EXEC_FAILED;
+
+        if(joined
+           && (hipEventRecord(p.done, p.stream) != hipSuccess
+               || hipStreamWaitEvent(plan->stream, p.done, 0) != hipSuccess))
+            return HIPFFT_EXEC_FAILED;
+    }
+    return HIPFFT_SUCCESS;
 }
 
-hipfftResult hipfftEstimateMany(int        rank,
-                                int*       n,
-                                int*       inembed,
-                                int        istride,
-                                int        idist,
-                                int*       onembed,
-                                int        ostride,
-                                int        odist,
-                                hipfftType type,
-                                int        batch,
-                                size_t*    workSize)
+// Multiply rows [row0, row0 + rows) of the first four-step pass's
+// output by their twiddles
+template <typename Real>
+static void hipfftOocTwiddle(
+    const hipfft_ooc_transform& t, void* data, size_t row0, size_t rows, bool forward)
 {
-    hipfftHandle plan = nullptr;
-    hipfftResult ret  = hipfftGetSizeMany(
-        plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch, workSize);
-    return ret;
+    auto twiddle_rows = [&](size_t begin, size_t end) {
+        auto row = static_cast<std::complex<Real>*>(data) + begin * t.n1;
+        for(size_t n2 = begin; n2 < end; ++n2, row += t.n1)
+        {
+            for(size_t k1 = 0; k1 < t.n1; ++k1)
+            {
+                const size_t e = n2 * k1;
+                auto         w = t.twiddle_hi[e / t.n1] * t.twiddle_lo[e % t.n1];
+                row[k1] *= std::complex<Real>(forward ? w : std::conj(w));
+            }
+        }
+    };
+
+    // spread big chunks over the worker pool, so that the host keeps
+    // up with the device.  This thread takes whatever parts the
+    // workers haven't started, in case they're busy making plans.
+    const size_t parts = std::min<size_t>({8, (rows * t.n1 >> 20) + 1, rows});
+    if(parts == 1)
+    {
+        twiddle_rows(row0, row0 + rows);
+        return;
+    }
+
+    struct shared_state
+    {
+        std::atomic<size_t>     next{0};
+        std::mutex              mutex;
+        std::condition_variable cv;
+        size_t                  finished = 0;
+    };
+    // pool tasks might outlive this function, if this thread claims
+    // all of the parts before they start
+    auto state = std::make_shared<shared_state>();
+    auto run   = [state, parts, row0, rows, twiddle_rows]() {
+        for(size_t i; (i = state->next++) < parts;)
+        {
+            twiddle_rows(row0 + rows * i / parts, row0 + rows * (i + 1) / parts);
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if(++state->finished == parts)
+                state->cv.notify_all();
+        }
+    };
+    for(size_t i = 1; i < parts; ++i)
+        hipfft_thread_pool::get().submit([run]() {
+            run();
+            return HIPFFT_SUCCESS;
+        });
+    run();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&]() { return state->finished == parts; });
 }
 
-hipfftResult
-    hipfftGetSize1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
+// Run one pass of an out-of-core transform from src to dst, moving
+// chunks of lines through two staging slots so that one chunk's
+// copies overlap with the other's transform
+static hipfftResult hipfftRunOocPass(hipfftHandle                plan,
+                                     const hipfft_ooc_transform& t,
+                                     const hipfft_ooc_pass&      pass,
+                                     bool                        forward,
+                                     const char*                 src,
+                                     hipfft_memory_kind          src_kind,
+                                     char*                       dst,
+                                     hipfft_memory_kind          dst_kind)
 {
+    auto&              slots = plan->staging->slots;
+    hipfft_host_copies copies;
+
+    auto twiddle = [&](size_t c) {
+        auto&        slot  = slots[c % 2];
+        const size_t l0    = c * pass.chunk;
+        const size_t count = std::min(pass.chunk, pass.lines - l0);
+        HIP_FFT_CHECK_AND_RETURN(copies.finish(slot.stream));
+        if(t.precision == rocfft_precision_double)
+            hipfftOocTwiddle<double>(t, dst, l0, count, forward);
+        else
+            hipfftOocTwiddle<float>(t, dst, l0, count, forward);
+        return HIPFFT_SUCCESS;
+    };
 
-    if(nx < 0 || batch < 0)
+    const size_t nchunks = (pass.lines + pass.chunk - 1) / pass.chunk;
+    for(size_t c = 0; c < nchunks; ++c)
     {
-        return HIPFFT_INVALID_SIZE;
+        auto&        slot  = slots[c % 2];
+        const size_t l0    = c * pass.chunk;
+        const size_t count = std::min(pass.chunk, pass.lines - l0);
+        const auto   rplan = pass.plans[forward ? 0 : 1][count == pass.chunk ? 0 : 1].get();
+        if(!rplan)
+            return HIPFFT_EXEC_FAILED;
+
+        // give back the pinned buffers of the slot's last chunk
+        if(c >= 2 && !pass.twiddle && dst_kind == hipfft_memory_kind::pageable)
+            HIP_FFT_CHECK_AND_RETURN(copies.finish(slot.stream));
+
+        const size_t in_width  = count * pass.in.line_bytes;
+        const size_t out_width = count * pass.out.line_bytes;
+        void*        in[1]     = {slot.in};
+        void*        out[1]    = {slot.out};
+        HIP_FFT_CHECK_AND_RETURN(copies.to_device(slot.in,
+                                                  src + l0 * pass.in.line_bytes,
+                                                  pass.in.pitch,
+                                                  in_width,
+                                                  pass.in.rows,
+                                                  src_kind,
+                                                  slot.stream));
+        if(rocfft_execute(rplan, in, out, slot.info) != rocfft_status_success)
+            return HIPFFT_EXEC_FAILED;
+        HIP_FFT_CHECK_AND_RETURN(copies.to_host(dst + l0 * pass.out.line_bytes,
+                                                pass.out.pitch,
+                                                slot.out,
+                                                out_width,
+                                                pass.out.rows,
+                                                dst_kind,
+                                                slot.stream));
+
+        // twiddle the previous chunk on the host while the device
+        // works on this one
+        if(pass.twiddle && c > 0)
+            HIP_FFT_CHECK_AND_RETURN(twiddle(c - 1));
     }
+    if(pass.twiddle)
+        HIP_FFT_CHECK_AND_RETURN(twiddle(nchunks - 1));
 
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&p));
-    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlan1d(p, nx, type, batch, workSize));
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
-
+    // the next pass reads what this one wrote
+    for(auto& slot : slots)
+        HIP_FFT_CHECK_AND_RETURN(copies.finish(slot.stream));
     return HIPFFT_SUCCESS;
 }
 
-hipfftResult hipfftGetSize2d(hipfftHandle plan, int nx, int ny, hipfftType type, size_t* workSize)
+// Execute an out-of-core plan.  Executions are synchronous: the
+// output is complete when this returns.
+static hipfftResult hipfftExecOutOfCore(hipfftHandle plan, void* idata, void* odata, int direction)
 {
-    if(nx < 0 || ny < 0)
+    const auto& t       = *plan->ooc;
+    const bool  forward = direction == HIPFFT_FORWARD;
+    const bool  inplace = idata == odata;
+    if(!idata || !odata || !t.passes.front().plans[forward ? 0 : 1][0])
+        return HIPFFT_EXEC_FAILED;
+
+    // the data is expected to be too big for the device, and device
+    // or managed memory would be copied through staging for nothing
+    const auto in_kind  = hipfftMemoryKind(idata);
+    const auto out_kind = inplace ? in_kind : hipfftMemoryKind(odata);
+    if(in_kind == hipfft_memory_kind::device || out_kind == hipfft_memory_kind::device)
+        return HIPFFT_INVALID_VALUE;
+    hipfft_plan_lock lock(plan);
+
+    // in-place four-step transforms can't write their first pass
+    // over input that's still to be read
+    const size_t bytes        = t.elements * t.element_bytes();
+    char*        intermediate = static_cast<char*>(odata);
+    if(inplace && t.n1)
     {
-        return HIPFFT_INVALID_SIZE;
+        if(plan->ooc_scratch_bytes < bytes)
+        {
+            void* scratch = nullptr;
+            plan->ooc_scratch.reset();
+            plan->ooc_scratch_bytes = 0;
+            if(hipHostMalloc(&scratch, bytes, hipHostMallocDefault) != hipSuccess)
+                return HIPFFT_ALLOC_FAILED;
+            plan->ooc_scratch.reset(scratch);
+            plan->ooc_scratch_bytes = bytes;
+        }
+        intermediate = static_cast<char*>(plan->ooc_scratch.get());
     }
 
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&p));
-    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlan2d(p, nx, ny, type, workSize));
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+    if(!plan->staging)
+        plan->staging = std::make_unique<hipfft_host_staging>();
+    auto& staging = *plan->staging;
+    HIP_FFT_CHECK_AND_RETURN(
+        staging.prepare(2, t.slot_in_bytes, t.slot_out_bytes, t.slot_work_bytes, false));
+
+    const auto mid_kind = intermediate == odata ? out_kind : hipfft_memory_kind::pinned;
+
+    // start after earlier work on the plan's stream, on the host too
+    // if it reads pageable input itself
+    if(hipEventRecord(staging.ready, plan->stream) != hipSuccess)
+        return HIPFFT_EXEC_FAILED;
+    if(in_kind == hipfft_memory_kind::pageable && hipEventSynchronize(staging.ready) != hipSuccess)
+        return HIPFFT_EXEC_FAILED;
+    for(auto& slot : staging.slots)
+    {
+        if(hipStreamWaitEvent(slot.stream, staging.ready, 0) != hipSuccess
+           || rocfft_execution_info_set_load_callback(slot.info, nullptr, nullptr, 0)
+                  != rocfft_status_success
+           || rocfft_execution_info_set_store_callback(slot.info, nullptr, nullptr, 0)
+                  != rocfft_status_success)
+            return HIPFFT_EXEC_FAILED;
+    }
 
+    for(size_t b = 0; b < t.batch; ++b)
+    {
+        const char* in  = static_cast<const char*>(idata) + b * bytes;
+        char*       out = static_cast<char*>(odata) + b * bytes;
+        char*       mid = intermediate == odata ? out : intermediate;
+        HIP_FFT_CHECK_AND_RETURN(
+            hipfftRunOocPass(plan, t, t.passes[0], forward, in, in_kind, mid, mid_kind));
+        HIP_FFT_CHECK_AND_RETURN(
+            hipfftRunOocPass(plan, t, t.passes[1], forward, mid, mid_kind, out, out_kind));
+    }
     return HIPFFT_SUCCESS;
 }
 
-hipfftResult
-    hipfftGetSize3d(hipfftHandle plan, int nx, int ny, int nz, hipfftType type, size_t* workSize)
+// Create the rocFFT plans for an out-of-core pass, with chunks small
+// enough that two of them, and their work buffers, fit in the budget
+static hipfftResult hipfftBuildOocPass(hipfft_ooc_pass& pass,
+                                       int              device,
+                                       rocfft_precision precision,
+                                       int              direction_hints,
+                                       size_t           budget)
 {
-    if(nx < 0 || ny < 0 || nz < 0)
+    const size_t per_line
+        = pass.in.rows * pass.in.line_bytes + pass.out.rows * pass.out.line_bytes;
+    pass.chunk = std::max<size_t>(1, std::min(pass.lines, budget / (2 * per_line)));
+    for(;;)
     {
+        pass.work_bytes = 0;
+        for(size_t dir = 0; dir < 2; ++dir)
+        {
+            const int hint
+                = dir == 0 ? HIPFFT_EXT_DIRECTION_FORWARD : HIPFFT_EXT_DIRECTION_BACKWARD;
+            for(size_t i = 0; i < 2; ++i)
+            {
+                pass.plans[dir][i].reset();
+                const size_t count = i == 0 ? pass.chunk : pass.lines % pass.chunk;
+                if(count == 0 || !(direction_hints & hint))
+                    continue;
+                HIP_FFT_CHECK_AND_RETURN(hipfft_plan_cache::get().find_or_create(
+                    pass.key(device, precision, dir == 0, count), pass.plans[dir][i]));
+                if(!pass.plans[dir][i])
+                    return HIPFFT_PARSE_ERROR;
+                size_t work = 0;
+                ROC_FFT_CHECK_INVALID_VALUE(
+                    rocfft_plan_get_work_buffer_size(pass.plans[dir][i].get(), &work));
+                pass.work_bytes = std::max(pass.work_bytes, work);
+            }
+        }
+        if(2 * (pass.chunk * per_line + pass.work_bytes) <= budget)
+            return HIPFFT_SUCCESS;
+        if(pass.chunk == 1)
+            return HIPFFT_ALLOC_FAILED;
+        pass.chunk /= 2;
+    }
+}
+
+template <typename T>
+static hipfftResult hipfftMakePlanOutOfCore(hipfftHandle plan,
+                                            int          rank,
+                                            T*           n,
+                                            T*           inembed,
+                                            T*           onembed,
+                                            hipfftIOType type,
+                                            T            batch,
+                                            size_t*      workSize)
+{
+    plan->pending_plan   = std::future<hipfftResult>();
+    plan->pending_staged = nullptr;
+    plan->pending_status = HIPFFT_SUCCESS;
+    for(auto subplan : {&plan->ip_forward, &plan->op_forward, &plan->ip_inverse, &plan->op_inverse})
+        *subplan = hipfft_subplan();
+    plan->scaled_subplans.clear();
+    plan->ooc.reset();
+    hipfftForgetDerivedPlans(plan);
+
+    // only contiguous complex-to-complex data is supported
+    if(type.is_real_to_complex() || type.is_complex_to_real()
+       || type.precision() == rocfft_precision_half || inembed || onembed)
+        return HIPFFT_NOT_IMPLEMENTED;
+    if(rank < 1 || rank > 3 || batch < 1 || std::any_of(n, n + rank, [](T val) { return val < 1; }))
         return HIPFFT_INVALID_SIZE;
+
+    // out-of-core plans have no work area of their own
+    if(plan->size_query)
+    {
+        if(workSize)
+            *workSize = 0;
+        return HIPFFT_SUCCESS;
     }
 
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&p));
-    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlan3d(p, nx, ny, nz, type, workSize));
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        return HIPFFT_INVALID_DEVICE;
 
-    return HIPFFT_SUCCESS;
-}
+    // use the plan's memory limit, or by default half of what's free
+    size_t budget = plan->memory_limit;
+    if(!budget)
+    {
+        size_t free = 0, total = 0;
+        if(hipMemGetInfo(&free, &total) != hipSuccess)
+            return HIPFFT_INVALID_DEVICE;
+        budget = free / 2;
+    }
 
-hipfftResult hipfftGetSizeMany(hipfftHandle plan,
-                               int          rank,
-                               int*         n,
-                               int*         inembed,
-                               int          istride,
-                               int          idist,
-                               int*         onembed,
-                               int          ostride,
-                               int          odist,
-                               hipfftType   type,
-                               int          batch,
-                               size_t*      workSize)
-{
+    auto t       = std::make_shared<hipfft_ooc_transform>();
+    t->precision = type.precision();
+    t->batch     = batch;
+    t->elements  = 1;
+    size_t lengths[3];
+    for(int i = 0; i < rank; ++i)
+    {
+        lengths[i] = n[rank - 1 - i];
+        t->elements *= lengths[i];
+    }
+    const size_t e = t->element_bytes();
 
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(
-        hipfftPlanMany(&p, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch));
-    *workSize = p->workBufferSize;
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+    hipfft_ooc_pass first, second;
+    if(rank == 1)
+    {
+        // N = n1 * n2, with n1 as close to sqrt(N) as possible.  The
+        // input is n1 rows of n2; the first pass transforms its
+        // columns and writes them out as rows, so that the second
+        // pass's column transforms leave the output in order.
+        const size_t N = lengths[0];
+        for(size_t d = static_cast<size_t>(std::sqrt(static_cast<double>(N))); d > 1; --d)
+        {
+            if(N % d == 0)
+            {
+                t->n1 = d;
+                break;
+            }
+        }
+        if(!t->n1)
+            return HIPFFT_INVALID_SIZE;
+        t->n2 = N / t->n1;
+
+        first.lengths = {t->n1, 0, 0};
+        first.lines   = t->n2;
+        first.in      = {t->n1, e, t->n2 * e, true};
+        first.out     = {1, t->n1 * e, N * e, false};
+        first.twiddle = true;
+
+        second.lengths = {t->n2, 0, 0};
+        second.lines   = t->n1;
+        second.in      = {t->n2, e, t->n1 * e, true};
+        second.out     = second.in;
+
+        const double pi = std::acos(-1.0);
+        t->twiddle_lo.resize(t->n1);
+        t->twiddle_hi.resize(t->n2);
+        for(size_t r = 0; r < t->n1; ++r)
+            t->twiddle_lo[r] = std::polar(1.0, -2.0 * pi * r / N);
+        for(size_t q = 0; q < t->n2; ++q)
+            t->twiddle_hi[q] = std::polar(1.0, -2.0 * pi * q * t->n1 / N);
+    }
+    else
+    {
+        // slabs of the faster dimensions, then pencils along the
+        // slowest one
+        const size_t slowest = lengths[rank - 1];
+        const size_t plane   = t->elements / slowest;
+
+        first.dim = rank - 1;
+        std::copy_n(lengths, rank - 1, first.lengths.begin());
+        first.lines = slowest;
+        first.in    = {1, plane * e, t->elements * e, false};
+        first.out   = first.in;
+
+        second.lengths = {slowest, 0, 0};
+        second.lines   = plane;
+        second.in      = {slowest, e, plane * e, true};
+        second.out     = second.in;
+    }
+    second.scale = plan->scale_factor;
 
+    for(auto pass : {&first, &second})
+    {
+        HIP_FFT_CHECK_AND_RETURN(
+            hipfftBuildOocPass(*pass, device, t->precision, plan->direction_hints, budget));
+        const size_t in_bytes  = pass->chunk * pass->in.rows * pass->in.line_bytes;
+        const size_t out_bytes = pass->chunk * pass->out.rows * pass->out.line_bytes;
+        t->slot_in_bytes       = std::max(t->slot_in_bytes, in_bytes);
+        t->slot_out_bytes      = std::max(t->slot_out_bytes, out_bytes);
+        t->slot_work_bytes     = std::max(t->slot_work_bytes, pass->work_bytes);
+    }
+    t->passes.push_back(std::move(first));
+    t->passes.push_back(std::move(second));
+
+    plan->type           = type;
+    plan->ooc            = std::move(t);
+    plan->workBufferSize = 0;
+    if(workSize)
+        *workSize = 0;
     return HIPFFT_SUCCESS;
 }
 
-hipfftResult hipfftGetSizeMany64(hipfftHandle   plan,
-                                 int            rank,
-                                 long long int* n,
-                                 long long int* inembed,
-                                 long long int  istride,
-                                 long long int  idist,
-                                 long long int* onembed,
-                                 long long int  ostride,
-                                 long long int  odist,
-                                 hipfftType     type,
-                                 long long int  batch,
-                                 size_t*        workSize)
+// Execute a sub-plan of a plan, with the plan's buffer_mutex held.
+// Plans that would borrow a work buffer, or allocate a deferred one,
+// use shared_work instead if it's given.
+static hipfftResult hipfftExecLocked(const hipfftHandle                   plan,
+                                     const hipfft_subplan*                subplan,
+                                     void*                                idata,
+                                     void*                                odata,
+                                     const hipfft_workbuffer_pool::block* shared_work = nullptr)
 {
-    hipfftHandle p = nullptr;
-    HIP_FFT_CHECK_AND_RETURN(hipfftPlanMany64(
-        &p, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch));
-    *workSize = p->workBufferSize;
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+    if(!subplan || !subplan->rplan)
+        return HIPFFT_EXEC_FAILED;
+    if(!idata || !odata)
+        return HIPFFT_EXEC_FAILED;
 
-    return HIPFFT_SUCCESS;
-}
+    // whether the execution is being captured into a graph.  Only
+    // asked where it makes a difference.
+    auto capturing = [&]() {
+        hipStreamCaptureStatus status = hipStreamCaptureStatusNone;
+        return hipStreamIsCapturing(plan->stream, &status) == hipSuccess
+               && status != hipStreamCaptureStatusNone;
+    };
 
-hipfftResult hipfftGetSize(hipfftHandle plan, size_t* workSize)
-{
-    *workSize = plan->workBufferSize;
-    return HIPFFT_SUCCESS;
-}
+    if(plan->staging_depth > 0)
+    {
+        const auto in_kind  = hipfftMemoryKind(idata);
+        const auto out_kind = idata == odata ? in_kind : hipfftMemoryKind(odata);
+        if(in_kind != hipfft_memory_kind::device || out_kind != hipfft_memory_kind::device)
+        {
+            // staging waits on the host
+            if(capturing())
+                return HIPFFT_NOT_SUPPORTED;
+            return hipfftExecStaged(plan, subplan, idata, odata, in_kind, out_kind);
+        }
+    }
+
+    const size_t sub_batch = subplan->key.number_of_transforms;
+    const size_t batch     = std::max(subplan->total_transforms, sub_batch);
 
-hipfftResult hipfftSetAutoAllocation(hipfftHandle plan, int autoAllocate)
-{
-    if(plan != nullptr)
-        plan->autoAllocate = bool(autoAllocate);
-    return HIPFFT_SUCCESS;
-}
+    // prefetched on the plan's stream, which executions split across
+    // streams start after
+    if(plan->prefetch_managed)
+    {
+        size_t in_bytes = 0, out_bytes = 0;
+        subplan->key.buffer_bytes(batch, in_bytes, out_bytes);
+        const int device = subplan->key.device;
+        if(idata == odata)
+        {
+            HIP_FFT_CHECK_AND_RETURN(
+                hipfftPrefetchIfManaged(plan, idata, std::max(in_bytes, out_bytes), device));
+        }
+        else
+        {
+            HIP_FFT_CHECK_AND_RETURN(hipfftPrefetchIfManaged(plan, idata, in_bytes, device));
+            HIP_FFT_CHECK_AND_RETURN(hipfftPrefetchIfManaged(plan, odata, out_bytes, device));
+        }
+        // only a caller-provided work area can be managed
+        if(plan->workBuffer && !plan->workBufferNeedsFree && plan->workBufferSize > 0)
+            HIP_FFT_CHECK_AND_RETURN(
+                hipfftPrefetchIfManaged(plan, plan->workBuffer, plan->workBufferSize, device));
+    }
 
-hipfftResult hipfftSetWorkArea(hipfftHandle plan, void* workArea)
-{
-    if(plan->workBuffer && plan->workBufferNeedsFree)
-        hipFree(plan->workBuffer);
-    plan->workBufferNeedsFree = false;
-    if(workArea)
+    if(hipfftSplitsBatch(plan, subplan))
+        return hipfftExecPartitioned(
+            plan, subplan, idata, odata, subplan->key.number_of_transforms, capturing());
+
+    // deferred work buffers are allocated on first execution, or the
+    // first one after the plan was trimmed
+    const bool needs_work = plan->autoAllocate && !plan->work_area_group && !plan->workBuffer
+                            && plan->workBufferSize > 0;
+    if(needs_work && shared_work)
     {
         ROC_FFT_CHECK_INVALID_VALUE(
-            rocfft_execution_info_set_work_buffer(plan->info, workArea, plan->workBufferSize));
+            hipfftSetInfoWorkBuffer(plan, shared_work->ptr, shared_work->size));
+    }
+    else if(needs_work)
+    {
+        // a captured execution can't borrow from the pool, which
+        // can't tell when the graph is done with a buffer, or allocate
+        // in stream order, which would leave the graph owning the
+        // buffer.  It gets a work buffer of its own instead.
+        const bool captured = capturing();
+        if(captured || plan->workBufferMode != HIPFFT_EXT_WORKBUFFER_POOL)
+            HIP_FFT_CHECK_AND_RETURN(
+                hipfftAllocWorkBufferNow(plan, plan->workBufferSize, !captured));
     }
-    return HIPFFT_SUCCESS;
-}
 
-// Find the specific plan to execute - check placement and direction
-static rocfft_plan get_exec_plan(const hipfftHandle plan, const bool inplace, const int direction)
-{
-    switch(direction)
+    // borrow a pooled work buffer just for this execution
+    const bool use_pool = needs_work && !shared_work && !plan->workBuffer
+                          && plan->workBufferMode == HIPFFT_EXT_WORKBUFFER_POOL;
+    hipfft_workbuffer_pool::block workBuffer;
+    if(use_pool)
     {
-    case HIPFFT_FORWARD:
-        return inplace ? plan->ip_forward : plan->op_forward;
-    case HIPFFT_BACKWARD:
-        return inplace ? plan->ip_inverse : plan->op_inverse;
+        auto& pool = hipfft_workbuffer_pool::get();
+        HIP_FFT_CHECK_AND_RETURN(pool.acquire(plan->workBufferSize, plan->stream, workBuffer));
+        if(hipfftSetInfoWorkBuffer(plan, workBuffer.ptr, workBuffer.size)
+           != rocfft_status_success)
+        {
+            pool.release(workBuffer, plan->stream);
+            return HIPFFT_EXEC_FAILED;
+        }
+    }
+
+    // a batch split up to fit a memory limit runs as several smaller
+    // ones, one after the other
+    size_t in_dist = 0, out_dist = 0;
+    if(batch > sub_batch)
+        subplan->key.batch_distances(in_dist, out_dist);
+
+    auto ret = rocfft_status_success;
+    for(size_t done = 0; done < batch && ret == rocfft_status_success;)
+    {
+        const size_t count = std::min(sub_batch, batch - done);
+        const auto   rplan
+            = count == sub_batch ? subplan->rplan.get() : subplan->remainder_rplan.get();
+        void* in[1]  = {static_cast<char*>(idata) + done * in_dist};
+        void* out[1] = {static_cast<char*>(odata) + done * out_dist};
+        ret          = rplan ? rocfft_execute(rplan, in, out, plan->info) : rocfft_status_failure;
+        done += count;
     }
-    return nullptr;
+    if(use_pool)
+        hipfft_workbuffer_pool::get().release(workBuffer, plan->stream);
+    return ret == rocfft_status_success ? HIPFFT_SUCCESS : HIPFFT_EXEC_FAILED;
 }
 
-static hipfftResult hipfftExec(const rocfft_plan&           rplan,
-                               const rocfft_execution_info& rinfo,
-                               void*                        idata,
-                               void*                        odata)
+// Execute a sub-plan of a plan
+static hipfftResult
+    hipfftExec(const hipfftHandle plan, const hipfft_subplan* subplan, void* idata, void* odata)
 {
-    if(!rplan)
-        return HIPFFT_EXEC_FAILED;
-    if(!idata || !odata)
-        return HIPFFT_EXEC_FAILED;
-    void*      in[1]  = {(void*)idata};
-    void*      out[1] = {(void*)odata};
-    const auto ret    = rocfft_execute(rplan, in, out, rinfo);
-    return ret == rocfft_status_success ? HIPFFT_SUCCESS : HIPFFT_EXEC_FAILED;
+    hipfft_plan_lock lock(plan);
+    return hipfftExecLocked(plan, subplan, idata, odata);
 }
 
 static hipfftResult hipfftExecForward(hipfftHandle plan, void* idata, void* odata)
 {
-    const bool inplace = idata == odata;
-    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_FORWARD);
-    return hipfftExec(rplan, plan->info, idata, odata);
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    if(plan->ooc)
+        return hipfftExecOutOfCore(plan, idata, odata, HIPFFT_FORWARD);
+
+    const bool            inplace = idata == odata;
+    const hipfft_subplan* subplan = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(get_exec_plan(plan, inplace, HIPFFT_FORWARD, subplan));
+    return hipfftExec(plan, subplan, idata, odata);
 }
 
 static hipfftResult hipfftExecBackward(hipfftHandle plan, void* idata, void* odata)
 {
-    const bool inplace = idata == odata;
-    const auto rplan   = get_exec_plan(plan, inplace, HIPFFT_BACKWARD);
-    return hipfftExec(rplan, plan->info, idata, odata);
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    if(plan->ooc)
+        return hipfftExecOutOfCore(plan, idata, odata, HIPFFT_BACKWARD);
+
+    const bool            inplace = idata == odata;
+    const hipfft_subplan* subplan = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(get_exec_plan(plan, inplace, HIPFFT_BACKWARD, subplan));
+    return hipfftExec(plan, subplan, idata, odata);
 }
 
 hipfftResult
@@ -1215,7 +4615,40 @@ hipfftResult hipfftExecZ2D(hipfftHandle plan, hipfftDoubleComplex* idata, hipfft
 
 hipfftResult hipfftSetStream(hipfftHandle plan, hipStream_t stream)
 {
+    hipfft_plan_lock lock(plan);
+
+    // a stream-ordered work buffer is only ordered on the stream it
+    // was allocated on, so it's freed there, after the executions
+    // already queued, and the next execution allocates one on the
+    // new stream
+    if(plan->workBufferAsync && plan->workBufferStream != stream)
+        HIP_FFT_CHECK_AND_RETURN(hipfftFreeWorkBuffer(plan));
+
     ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_set_stream(plan->info, stream));
+    plan->stream = stream;
+
+    // graphs of split executions use the stream set
+    if(plan->stream_set)
+        plan->graphs.reset();
+    plan->stream_set.reset();
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtSetStreams(hipfftHandle plan, int count, hipStream_t streams[])
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(count < 1 || !streams)
+        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftSetStream(plan, streams[0]));
+    if(count == 1)
+        return HIPFFT_SUCCESS;
+
+    auto set = std::make_unique<hipfft_stream_set>();
+    HIP_FFT_CHECK_AND_RETURN(set->init(count, streams));
+    hipfft_plan_lock lock(plan);
+    plan->graphs.reset();
+    plan->stream_set = std::move(set);
     return HIPFFT_SUCCESS;
 }
 
@@ -1223,23 +4656,150 @@ hipfftResult hipfftDestroy(hipfftHandle plan)
 {
     if(plan != nullptr)
     {
-        if(plan->ip_forward != nullptr)
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_destroy(plan->ip_forward));
-        if(plan->op_forward != nullptr)
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_destroy(plan->op_forward));
-        if(plan->ip_inverse != nullptr)
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_destroy(plan->ip_inverse));
-        if(plan->op_inverse != nullptr)
-            ROC_FFT_CHECK_INVALID_VALUE(rocfft_plan_destroy(plan->op_inverse));
+        hipfft_handle_pool::get().retire(plan);
+
+        // rocfft_plans are released when the last handle (or the plan
+        // cache) referring to them lets go
+        hipfftWorkAreaGroupDetach(plan);
+        hipfftFreeWorkBuffer(plan);
+
+        HIP_FFT_CHECK_AND_RETURN(hipfft_handle_pool::get().release(plan));
+    }
+
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtSetBatch(hipfftHandle plan, long long int batch)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(batch < 1)
+        return HIPFFT_INVALID_SIZE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+
+    const std::array<hipfft_subplan*, 4> subplans
+        = {&plan->ip_forward, &plan->op_forward, &plan->ip_inverse, &plan->op_inverse};
+    const auto num_valid = std::count_if(
+        subplans.begin(), subplans.end(), [](hipfft_subplan* subplan) { return subplan->valid; });
+    if(num_valid == 0)
+        return HIPFFT_INVALID_PLAN;
+
+    // keep the current sub-plans, to put back if re-planning fails
+    const std::array<hipfft_subplan, 4> previous
+        = {plan->ip_forward, plan->op_forward, plan->ip_inverse, plan->op_inverse};
+    const auto   previous_scaled         = plan->scaled_subplans;
+    const double previous_build_seconds  = plan->build_seconds;
+    const size_t previous_workBufferSize = plan->workBufferSize;
+
+    // Lengths, strides, distances and types are unchanged, so only
+    // the batch count in the sub-plans' keys needs updating.  Plans
+    // for batch counts seen before come from the plan cache, and new
+    // ones reuse kernels that rocFFT has already compiled.
+    const auto replan = [&]() {
+        for(auto subplan : subplans)
+        {
+            subplan->key.number_of_transforms = batch;
+            subplan->rplan.reset();
+            subplan->attempted        = false;
+            subplan->sized            = false;
+            subplan->build_seconds    = 0.0;
+            subplan->total_transforms = batch;
+            subplan->remainder_rplan.reset();
+        }
+        plan->build_seconds = 0.0;
+
+        plan->scaled_subplans.clear();
+
+        // lazy sub-plans are rebuilt on first use, growing the work
+        // buffer as needed
+        if(plan->lazy_plans && !plan->memory_limit && plan->dynamic_scales.empty())
+            return HIPFFT_SUCCESS;
 
-        if(plan->workBufferNeedsFree)
-            hipFree(plan->workBuffer);
+        size_t workBufferSize = 0;
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplansWithinLimit(plan, workBufferSize));
+        if(!plan->ip_forward.sized && !plan->op_forward.sized && !plan->ip_inverse.sized
+           && !plan->op_inverse.sized)
+            return HIPFFT_PARSE_ERROR;
+
+        size_t scaledWorkBufferSize = 0;
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateScaledSubplans(plan, scaledWorkBufferSize));
+        workBufferSize = std::max(workBufferSize, scaledWorkBufferSize);
+
+        plan->workBufferSize = workBufferSize;
+        if(workBufferSize > 0 && plan->autoAllocate)
+            HIP_FFT_CHECK_AND_RETURN(hipfftGrowWorkBuffer(plan, workBufferSize));
+        return HIPFFT_SUCCESS;
+    };
 
-        ROC_FFT_CHECK_INVALID_VALUE(rocfft_execution_info_destroy(plan->info));
+    const auto res = replan();
+    if(res != HIPFFT_SUCCESS)
+    {
+        // a work buffer freed on the way is allocated again when the
+        // plan is next executed
+        for(size_t i = 0; i < subplans.size(); ++i)
+            *subplans[i] = previous[i];
+        plan->scaled_subplans = previous_scaled;
+        plan->build_seconds   = previous_build_seconds;
+        plan->workBufferSize  = previous_workBufferSize;
+        return res;
+    }
+    hipfftForgetDerivedPlans(plan);
+    return HIPFFT_SUCCESS;
+}
 
-        delete plan;
+hipfftResult hipfftExtPlanClone(hipfftHandle src, hipfftHandle* dst)
+{
+    if(!src)
+        return HIPFFT_INVALID_PLAN;
+    if(!dst)
+        return HIPFFT_INVALID_VALUE;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(src));
+
+    hipfftHandle clone = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&clone));
+
+    // rocfft_plans are shared with the source
+    clone->type             = src->type;
+    clone->ip_forward       = src->ip_forward;
+    clone->op_forward       = src->op_forward;
+    clone->ip_inverse       = src->ip_inverse;
+    clone->op_inverse       = src->op_inverse;
+    clone->workBufferSize   = src->workBufferSize;
+    clone->autoAllocate     = src->autoAllocate;
+    clone->workBufferMode   = src->workBufferMode;
+    clone->scale_factor     = src->scale_factor;
+    clone->dynamic_scales   = src->dynamic_scales;
+    clone->scaled_subplans  = src->scaled_subplans;
+    clone->lazy_plans       = src->lazy_plans;
+    clone->concurrent_build = src->concurrent_build;
+    clone->placement_hints  = src->placement_hints;
+    clone->direction_hints  = src->direction_hints;
+    clone->memory_limit     = src->memory_limit;
+    clone->prefetch_managed = src->prefetch_managed;
+    clone->staging_depth    = src->staging_depth;
+    clone->staging_chunk    = src->staging_chunk;
+    clone->out_of_core      = src->out_of_core;
+    clone->ooc              = src->ooc;
+    clone->build_seconds    = src->build_seconds;
+
+    clone->load_callback_ptrs       = src->load_callback_ptrs;
+    clone->load_callback_data       = src->load_callback_data;
+    clone->load_callback_lds_bytes  = src->load_callback_lds_bytes;
+    clone->store_callback_ptrs      = src->store_callback_ptrs;
+    clone->store_callback_data      = src->store_callback_data;
+    clone->store_callback_lds_bytes = src->store_callback_lds_bytes;
+
+    // but the clone gets its own work buffer and execution info
+    auto res = hipfftSetInfoCallbacks(clone);
+    if(res == HIPFFT_SUCCESS && clone->autoAllocate && clone->workBufferSize > 0)
+        res = hipfftAllocWorkBuffer(clone, clone->workBufferSize);
+    if(res != HIPFFT_SUCCESS)
+    {
+        hipfftDestroy(clone);
+        return res;
     }
 
+    *dst = clone;
     return HIPFFT_SUCCESS;
 }
 
@@ -1299,6 +4859,7 @@ hipfftResult hipfftXtSetCallback(hipfftHandle         plan,
 {
     if(!plan)
         return HIPFFT_INVALID_PLAN;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
 
     // check that the input/output type matches what's being requested
     //
@@ -1367,20 +4928,7 @@ hipfftResult hipfftXtSetCallback(hipfftHandle         plan,
         return HIPFFT_INVALID_VALUE;
     }
 
-    rocfft_status res;
-    res = rocfft_execution_info_set_load_callback(plan->info,
-                                                  plan->load_callback_ptrs,
-                                                  plan->load_callback_data,
-                                                  plan->load_callback_lds_bytes);
-    if(res != rocfft_status_success)
-        return HIPFFT_INVALID_VALUE;
-    res = rocfft_execution_info_set_store_callback(plan->info,
-                                                   plan->store_callback_ptrs,
-                                                   plan->store_callback_data,
-                                                   plan->store_callback_lds_bytes);
-    if(res != rocfft_status_success)
-        return HIPFFT_INVALID_VALUE;
-    return HIPFFT_SUCCESS;
+    return hipfftSetInfoCallbacks(plan);
 }
 
 hipfftResult hipfftXtClearCallback(hipfftHandle plan, hipfftXtCallbackType cbtype)
@@ -1393,6 +4941,7 @@ hipfftResult
 {
     if(!plan)
         return HIPFFT_INVALID_PLAN;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
 
     switch(cbtype)
     {
@@ -1412,20 +4961,7 @@ hipfftResult
         return HIPFFT_INVALID_VALUE;
     }
 
-    rocfft_status res;
-    res = rocfft_execution_info_set_load_callback(plan->info,
-                                                  plan->load_callback_ptrs,
-                                                  plan->load_callback_data,
-                                                  plan->load_callback_lds_bytes);
-    if(res != rocfft_status_success)
-        return HIPFFT_INVALID_VALUE;
-    res = rocfft_execution_info_set_store_callback(plan->info,
-                                                   plan->store_callback_ptrs,
-                                                   plan->store_callback_data,
-                                                   plan->store_callback_lds_bytes);
-    if(res != rocfft_status_success)
-        return HIPFFT_INVALID_VALUE;
-    return HIPFFT_SUCCESS;
+    return hipfftSetInfoCallbacks(plan);
 }
 
 hipfftResult hipfftXtMakePlanMany(hipfftHandle   plan,
@@ -1449,6 +4985,229 @@ hipfftResult hipfftXtMakePlanMany(hipfftHandle   plan,
         plan, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
 }
 
+// Estimate the device memory a rocfft_plan for the key would need,
+// without creating it.  rocFFT doesn't report this, so it's modelled
+// on how rocFFT decomposes transforms, erring on the high side:
+//
+// - Each FFT length needs a twiddle table of that length.
+// - Lengths with prime factors rocFFT has no kernels for use
+//   Bluestein's algorithm, which needs a chirp table and three
+//   buffers at a padded power-of-two length.
+// - 1D lengths too large for one kernel are split into several
+//   kernels with an extra twiddle table, passing data through a
+//   data-sized work buffer.  Multi-dimensional and real transforms
+//   may do the same.
+// - Each kernel keeps a small table of lengths and strides.
+static void hipfftEstimateSubplanFootprint(const hipfft_plan_key& key,
+                                           size_t&                workBufferBytes,
+                                           size_t&                twiddleBytes,
+                                           size_t&                subPlanBytes)
+{
+    const size_t complex_bytes = key.precision == rocfft_precision_double ? 16
+                                 : key.precision == rocfft_precision_half ? 4
+                                                                          : 8;
+    const size_t single_kernel_max = key.precision == rocfft_precision_double ? 2048 : 4096;
+    const bool   is_real           = key.transform_type == rocfft_transform_type_real_forward
+                           || key.transform_type == rocfft_transform_type_real_inverse;
+
+    // complex elements in one transform
+    size_t elems = 1;
+    for(size_t i = 0; i < key.dim; ++i)
+        elems *= is_real && i == 0 ? key.lengths[i] / 2 + 1 : key.lengths[i];
+    const size_t data_bytes = elems * key.number_of_transforms * complex_bytes;
+
+    workBufferBytes = (key.dim > 1 || is_real) ? data_bytes : 0;
+    twiddleBytes    = 0;
+    size_t kernels  = 0;
+    for(size_t i = 0; i < key.dim; ++i)
+    {
+        const size_t len = key.lengths[i];
+
+        size_t remaining = len;
+        for(size_t radix : {2, 3, 5, 7, 11, 13, 17})
+            while(remaining > 1 && remaining % radix == 0)
+                remaining /= radix;
+
+        if(remaining > 1)
+        {
+            size_t padded = 1;
+            while(padded < 2 * len - 1)
+                padded *= 2;
+            twiddleBytes += (padded + len) * complex_bytes;
+            const size_t bluestein_bytes
+                = 3 * padded * (elems / len) * key.number_of_transforms * complex_bytes;
+            workBufferBytes = std::max(workBufferBytes, bluestein_bytes);
+            kernels += 3;
+        }
+        else if(len > single_kernel_max)
+        {
+            twiddleBytes += 2 * len * complex_bytes;
+            workBufferBytes = std::max(workBufferBytes, data_bytes);
+            kernels += 3;
+        }
+        else
+        {
+            twiddleBytes += len * complex_bytes;
+            kernels += 1;
+        }
+    }
+    subPlanBytes = kernels * 3 * std::max<size_t>(key.dim, 1) * sizeof(size_t);
+}
+
+hipfftResult hipfftExtEstimateFootprint(hipfftHandle        plan,
+                                        int                 rank,
+                                        long long int*      n,
+                                        long long int*      inembed,
+                                        long long int       istride,
+                                        long long int       idist,
+                                        hipDataType         inputtype,
+                                        long long int*      onembed,
+                                        long long int       ostride,
+                                        long long int       odist,
+                                        hipDataType         outputtype,
+                                        long long int       batch,
+                                        hipDataType         executiontype,
+                                        hipfftExtFootprint* footprint)
+{
+    if(!footprint)
+        return HIPFFT_INVALID_VALUE;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(inputtype, outputtype, executiontype));
+
+    // a lazy plan works out the sub-plans' keys without creating them
+    hipfftHandle_t query;
+    hipfftInitSizeQuery(query, plan);
+    query.lazy_plans = true;
+    // estimates are for the full batch, not split to fit a limit,
+    // and kept on the device
+    query.memory_limit = 0;
+    query.out_of_core  = false;
+    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlanMany_internal<long long int>(
+        &query, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, nullptr));
+
+    *footprint                   = hipfftExtFootprint();
+    footprint->work_buffer_exact = 1;
+    for(auto subplan : {&query.ip_forward, &query.op_forward, &query.ip_inverse, &query.op_inverse})
+    {
+        if(!subplan->valid)
+            continue;
+
+        size_t workBufferBytes = 0, twiddleBytes = 0, subPlanBytes = 0;
+        hipfftEstimateSubplanFootprint(subplan->key, workBufferBytes, twiddleBytes, subPlanBytes);
+
+        // use the real work buffer size if this plan has been
+        // created before
+        if(!hipfft_wisdom::get().lookup(subplan->key, workBufferBytes))
+            footprint->work_buffer_exact = 0;
+
+        // sub-plans share the plan's work buffer
+        footprint->work_buffer_bytes = std::max(footprint->work_buffer_bytes, workBufferBytes);
+        footprint->twiddle_bytes += twiddleBytes;
+        footprint->sub_plan_bytes += subPlanBytes;
+        ++footprint->num_sub_plans;
+    }
+
+    // callback data is allocated by the caller, so hipFFT itself
+    // needs nothing for callbacks
+    footprint->callback_bytes = 0;
+    footprint->total_bytes    = footprint->work_buffer_bytes + footprint->twiddle_bytes
+                             + footprint->sub_plan_bytes + footprint->callback_bytes;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtMakePlanManyAsync(hipfftHandle   plan,
+                                        int            rank,
+                                        long long int* n,
+                                        long long int* inembed,
+                                        long long int  istride,
+                                        long long int  idist,
+                                        hipDataType    inputtype,
+                                        long long int* onembed,
+                                        long long int  ostride,
+                                        long long int  odist,
+                                        hipDataType    outputtype,
+                                        long long int  batch,
+                                        hipDataType    executiontype)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(rank < 1 || rank > 3 || !n)
+        return HIPFFT_INVALID_VALUE;
+
+    hipfftIOType iotype;
+    HIP_FFT_CHECK_AND_RETURN(iotype.init(inputtype, outputtype, executiontype));
+
+    // the current device is per-thread, so tell the worker which
+    // device to plan for
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        return HIPFFT_INVALID_DEVICE;
+
+    // the caller's arrays need not outlive this call
+    std::vector<long long int> n_copy(n, n + rank);
+    std::vector<long long int> inembed_copy, onembed_copy;
+    if(inembed)
+        inembed_copy.assign(inembed, inembed + rank);
+    if(onembed)
+        onembed_copy.assign(onembed, onembed + rank);
+
+    // plan into a staging handle with the same settings, so the
+    // worker never touches the caller's handle
+    auto staged              = std::make_shared<hipfftHandle_t>();
+    staged->scale_factor     = plan->scale_factor;
+    staged->dynamic_scales   = plan->dynamic_scales;
+    staged->lazy_plans       = plan->lazy_plans;
+    staged->concurrent_build = plan->concurrent_build;
+    staged->placement_hints  = plan->placement_hints;
+    staged->direction_hints  = plan->direction_hints;
+    staged->memory_limit     = plan->memory_limit;
+    staged->out_of_core      = plan->out_of_core;
+    staged->autoAllocate     = false;
+
+    auto task = [=]() mutable {
+        if(hipSetDevice(device) != hipSuccess)
+            return HIPFFT_INVALID_DEVICE;
+        return hipfftMakePlanMany_internal<long long int>(
+            staged.get(),
+            rank,
+            n_copy.data(),
+            inembed_copy.empty() ? nullptr : inembed_copy.data(),
+            istride,
+            idist,
+            onembed_copy.empty() ? nullptr : onembed_copy.data(),
+            ostride,
+            odist,
+            iotype,
+            batch,
+            nullptr);
+    };
+
+    // any plan previously held by the handle is replaced once this
+    // one is ready
+    plan->pending_plan   = hipfft_thread_pool::get().submit(std::move(task));
+    plan->pending_staged = std::move(staged);
+    plan->pending_status = HIPFFT_SUCCESS;
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtPlanWait(hipfftHandle plan)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    return hipfftFinishPending(plan);
+}
+
+hipfftResult hipfftExtPlanQuery(hipfftHandle plan)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    if(plan->pending_plan.valid()
+       && plan->pending_plan.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return HIPFFT_PLAN_NOT_READY;
+    return hipfftFinishPending(plan);
+}
+
 hipfftResult hipfftXtGetSizeMany(hipfftHandle   plan,
                                  int            rank,
                                  long long int* n,
@@ -1467,29 +5226,364 @@ hipfftResult hipfftXtGetSizeMany(hipfftHandle   plan,
     hipfftIOType iotype;
     HIP_FFT_CHECK_AND_RETURN(iotype.init(inputtype, outputtype, executiontype));
 
-    hipfftHandle p;
-    HIP_FFT_CHECK_AND_RETURN(hipfftCreate(&p));
+    hipfftHandle_t query;
+    hipfftInitSizeQuery(query, plan);
+    return hipfftMakePlanMany_internal(
+        &query, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize);
+}
 
-    HIP_FFT_CHECK_AND_RETURN(hipfftMakePlanMany_internal(
-        p, rank, n, inembed, istride, idist, onembed, ostride, odist, iotype, batch, workSize));
-    HIP_FFT_CHECK_AND_RETURN(hipfftDestroy(p));
+// Find the sub-plan for an hipfftXtExec-style execution, where real
+// transforms ignore the direction
+static hipfftResult get_xt_exec_plan(hipfftHandle           plan,
+                                     const bool             inplace,
+                                     const int              direction,
+                                     const hipfft_subplan*& subplan)
+{
+    subplan = nullptr;
+    if(plan->type.is_real_to_complex() || direction == HIPFFT_FORWARD)
+    {
+        HIP_FFT_CHECK_AND_RETURN(get_exec_plan(plan, inplace, HIPFFT_FORWARD, subplan));
+    }
+    else if(plan->type.is_complex_to_real() || direction == HIPFFT_BACKWARD)
+    {
+        HIP_FFT_CHECK_AND_RETURN(get_exec_plan(plan, inplace, HIPFFT_BACKWARD, subplan));
+    }
+    if(!subplan || !subplan->rplan)
+        return HIPFFT_INTERNAL_ERROR;
     return HIPFFT_SUCCESS;
 }
 
 hipfftResult hipfftXtExec(hipfftHandle plan, void* input, void* output, int direction)
 {
-    bool        inplace  = input == output;
-    rocfft_plan plan_ptr = nullptr;
-    if(plan->type.is_real_to_complex() || direction == HIPFFT_FORWARD)
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    if(plan->ooc)
+        return hipfftExecOutOfCore(plan, input, output, direction);
+
+    const hipfft_subplan* subplan = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(get_xt_exec_plan(plan, input == output, direction, subplan));
+    return hipfftExec(plan, subplan, input, output);
+}
+
+// Find or create a sub-plan that runs the first nbatch transforms of
+// a full one.  Under a memory limit, it keeps the full sub-plan's
+// piece size and only needs its own plan for the last piece.
+static hipfftResult get_batch_subplan(hipfftHandle           plan,
+                                      const hipfft_subplan*  full,
+                                      size_t                 nbatch,
+                                      const hipfft_subplan*& subplan)
+{
+    auto key                 = full->key;
+    key.number_of_transforms = std::min(key.number_of_transforms, nbatch);
+
+    auto& cache = plan->batch_subplans;
+    for(auto it = cache.begin(); it != cache.end(); ++it)
     {
-        plan_ptr = inplace ? plan->ip_forward : plan->op_forward;
+        if(it->total_transforms == nbatch && !(it->key < key) && !(key < it->key))
+        {
+            cache.splice(cache.begin(), cache, it);
+            subplan = &cache.front();
+            return HIPFFT_SUCCESS;
+        }
     }
-    else if(plan->type.is_complex_to_real() || direction == HIPFFT_BACKWARD)
+
+    hipfft_subplan variant;
+    variant.key              = key;
+    variant.valid            = true;
+    variant.total_transforms = nbatch;
+    size_t workBufferSize    = 0;
+    if(key.number_of_transforms == full->key.number_of_transforms)
+    {
+        variant.rplan     = full->rplan;
+        variant.attempted = true;
+    }
+    else
     {
-        plan_ptr = inplace ? plan->ip_inverse : plan->op_inverse;
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplan(variant, workBufferSize));
     }
-    if(!plan_ptr)
+    if(!variant.rplan)
         return HIPFFT_INTERNAL_ERROR;
 
-    return hipfftExec(plan_ptr, plan->info, input, output);
+    const size_t remainder = nbatch % key.number_of_transforms;
+    if(remainder != 0
+       && remainder == full->total_transforms % full->key.number_of_transforms)
+        variant.remainder_rplan = full->remainder_rplan;
+    else if(remainder != 0)
+    {
+        hipfft_subplan last;
+        last.key                      = key;
+        last.key.number_of_transforms = remainder;
+        last.valid                    = true;
+        size_t lastWorkBufferSize     = 0;
+        HIP_FFT_CHECK_AND_RETURN(hipfftCreateSubplan(last, lastWorkBufferSize));
+        if(!last.rplan)
+            return HIPFFT_INTERNAL_ERROR;
+        variant.remainder_rplan = std::move(last.rplan);
+        workBufferSize          = std::max(workBufferSize, lastWorkBufferSize);
+    }
+    HIP_FFT_CHECK_AND_RETURN(hipfftReserveWorkBuffer(plan, workBufferSize));
+
+    cache.push_front(std::move(variant));
+    if(cache.size() > 4)
+        cache.pop_back();
+    subplan = &cache.front();
+    return HIPFFT_SUCCESS;
+}
+
+hipfftResult hipfftExtExecBatch(
+    hipfftHandle plan, void* idata, void* odata, int direction, long long int nbatch)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    if(plan->ooc)
+        return HIPFFT_NOT_SUPPORTED;
+
+    const hipfft_subplan* subplan = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(get_xt_exec_plan(plan, idata == odata, direction, subplan));
+    const size_t batch = std::max(subplan->total_transforms, subplan->key.number_of_transforms);
+    if(nbatch < 1 || static_cast<unsigned long long>(nbatch) > batch)
+        return HIPFFT_INVALID_SIZE;
+    if(static_cast<size_t>(nbatch) < batch)
+    {
+        HIP_FFT_CHECK_AND_RETURN(get_batch_subplan(plan, subplan, nbatch, subplan));
+    }
+    return hipfftExec(plan, subplan, idata, odata);
+}
+
+hipfftResult
+    hipfftExtExecScaled(hipfftHandle plan, void* idata, void* odata, int direction, double scale)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    if(plan->ooc)
+        return HIPFFT_NOT_SUPPORTED;
+
+    const hipfft_subplan* subplan = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(get_xt_exec_plan(plan, idata == odata, direction, subplan));
+    if(scale != subplan->key.scale_factor)
+    {
+        // only the factors the plan was created with have sub-plans
+        const auto variants = plan->scaled_subplans.find(scale);
+        if(variants == plan->scaled_subplans.end())
+            return HIPFFT_INVALID_VALUE;
+        const std::array<const hipfft_subplan*, 4> subplans
+            = {&plan->ip_forward, &plan->op_forward, &plan->ip_inverse, &plan->op_inverse};
+        const auto index = std::find(subplans.begin(), subplans.end(), subplan) - subplans.begin();
+        subplan          = &variants->second[index];
+        if(!subplan->rplan)
+            return HIPFFT_INTERNAL_ERROR;
+    }
+    return hipfftExec(plan, subplan, idata, odata);
+}
+
+hipfftResult hipfftExtExecGraph(hipfftHandle plan, void* idata, void* odata, int direction)
+{
+    if(!plan)
+        return HIPFFT_INVALID_PLAN;
+    HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+    if(plan->ooc)
+        return HIPFFT_NOT_SUPPORTED;
+    if(!idata || !odata)
+        return HIPFFT_EXEC_FAILED;
+
+    const hipfft_subplan* subplan = nullptr;
+    HIP_FFT_CHECK_AND_RETURN(get_xt_exec_plan(plan, idata == odata, direction, subplan));
+
+    // the plan's stream is swapped for the capture, so other threads
+    // executing the plan wait until it's put back
+    hipfft_plan_lock lock(plan);
+
+    // the graph uses whatever work buffer the plan has when it's
+    // captured, so make sure that's one of its own
+    hipfft_graph_cache::entry key;
+    if(plan->autoAllocate && !plan->work_area_group && !plan->workBuffer
+       && plan->workBufferSize > 0)
+        HIP_FFT_CHECK_AND_RETURN(hipfftAllocWorkBufferNow(plan, plan->workBufferSize, false));
+
+    // a split execution's work slices can't be grown while it's
+    // captured, so they're sized first
+    if(hipfftSplitsBatch(plan, subplan))
+    {
+        rocfft_plan_ptr part_plans[2];
+        size_t          chunk = 0;
+        HIP_FFT_CHECK_AND_RETURN(hipfftReservePartitions(
+            plan, subplan, subplan->key.number_of_transforms, false, part_plans, chunk));
+    }
+    key.work = plan->work_area_group ? plan->work_area_group->buffer : plan->workBuffer;
+    key.rplan           = subplan->rplan;
+    key.remainder_rplan = subplan->remainder_rplan;
+    key.idata           = idata;
+    key.odata           = odata;
+    key.callbacks[0]    = plan->load_callback_ptrs;
+    key.callbacks[1]    = plan->load_callback_data;
+    key.callbacks[2]    = plan->store_callback_ptrs;
+    key.callbacks[3]    = plan->store_callback_data;
+    key.stream_set      = plan->stream_set.get();
+    key.set_work        = plan->stream_set ? plan->stream_set->work : nullptr;
+
+    if(!plan->graphs)
+        plan->graphs = std::make_unique<hipfft_graph_cache>();
+    auto& graphs = *plan->graphs;
+    auto  it     = std::find_if(graphs.entries.begin(),
+                           graphs.entries.end(),
+                           [&](const hipfft_graph_cache::entry& e) { return e.matches(key); });
+    if(it == graphs.entries.end())
+    {
+        if(!graphs.stream
+           && hipStreamCreateWithFlags(&graphs.stream, hipStreamNonBlocking) != hipSuccess)
+        {
+            graphs.stream = nullptr;
+            return HIPFFT_EXEC_FAILED;
+        }
+
+        // capture an ordinary execution on the cache's stream
+        const auto plan_stream = plan->stream;
+        if(rocfft_execution_info_set_stream(plan->info, graphs.stream) != rocfft_status_success)
+            return HIPFFT_EXEC_FAILED;
+        plan->stream = graphs.stream;
+
+        hipGraph_t graph = nullptr;
+        auto       res   = HIPFFT_EXEC_FAILED;
+        if(hipStreamBeginCapture(graphs.stream, hipStreamCaptureModeThreadLocal) == hipSuccess)
+        {
+            res = hipfftExecLocked(plan, subplan, idata, odata);
+            if(hipStreamEndCapture(graphs.stream, &graph) != hipSuccess && res == HIPFFT_SUCCESS)
+                res = HIPFFT_EXEC_FAILED;
+        }
+        plan->stream = plan_stream;
+        rocfft_execution_info_set_stream(plan->info, plan_stream);
+
+        if(res == HIPFFT_SUCCESS
+           && hipGraphInstantiate(&key.exec, graph, nullptr, nullptr, 0) != hipSuccess)
+        {
+            key.exec = nullptr;
+            res      = HIPFFT_EXEC_FAILED;
+        }
+        if(graph)
+            hipGraphDestroy(graph);
+        HIP_FFT_CHECK_AND_RETURN(res);
+
+        if(graphs.entries.size() == hipfft_graph_cache::capacity)
+        {
+            hipGraphExecDestroy(graphs.entries.back().exec);
+            graphs.entries.pop_back();
+        }
+        it = graphs.entries.insert(graphs.entries.begin(), std::move(key));
+    }
+    else if(it != graphs.entries.begin())
+        graphs.entries.splice(graphs.entries.begin(), graphs.entries, it);
+
+    return hipGraphLaunch(it->exec, plan->stream) == hipSuccess ? HIPFFT_SUCCESS
+                                                                : HIPFFT_EXEC_FAILED;
+}
+
+hipfftResult hipfftExtExecGroup(int          count,
+                                hipfftHandle plans[],
+                                void*        idata[],
+                                void*        odata[],
+                                const int    directions[],
+                                hipStream_t  stream)
+{
+    if(count < 0 || (count > 0 && (!plans || !idata || !odata || !directions)))
+        return HIPFFT_INVALID_VALUE;
+
+    // find every sub-plan before executing anything, so that a bad
+    // entry leaves nothing half done
+    std::vector<const hipfft_subplan*> subplans(count);
+    size_t                             shared_size = 0;
+    for(int i = 0; i < count; ++i)
+    {
+        const auto plan = plans[i];
+        if(!plan)
+            return HIPFFT_INVALID_PLAN;
+        HIP_FFT_CHECK_AND_RETURN(hipfftFinishPending(plan));
+        if(plan->ooc)
+            return HIPFFT_NOT_SUPPORTED;
+        HIP_FFT_CHECK_AND_RETURN(
+            get_xt_exec_plan(plan, idata[i] == odata[i], directions[i], subplans[i]));
+        if(plan->autoAllocate && !plan->work_area_group && !plan->workBuffer)
+            shared_size = std::max(shared_size, plan->workBufferSize);
+    }
+
+    // the transforms run one after the other on the stream, so plans
+    // that don't have a work buffer of their own can all share one
+    auto&                         pool = hipfft_workbuffer_pool::get();
+    hipfft_workbuffer_pool::block shared_work;
+    if(shared_size > 0)
+        HIP_FFT_CHECK_AND_RETURN(pool.acquire(shared_size, stream, shared_work));
+
+    // rocFFT can't take a work buffer back from an execution info, so
+    // plans borrowing the shared one run with an info of the group's
+    // instead of being left pointing at it
+    rocfft_execution_info group_info = nullptr;
+    if(shared_size > 0 && rocfft_execution_info_create(&group_info) != rocfft_status_success)
+    {
+        pool.release(shared_work, stream);
+        return HIPFFT_EXEC_FAILED;
+    }
+
+    // orders plans' stream-ordered work buffers with the group's
+    // stream, if any are allocated on another one
+    hipEvent_t order = nullptr;
+
+    auto res = HIPFFT_SUCCESS;
+    for(int i = 0; i < count && res == HIPFFT_SUCCESS; ++i)
+    {
+        // the plan's stream and info are swapped for the execution, so
+        // other threads executing the plan wait until they're put back
+        const auto                  plan = plans[i];
+        hipfft_plan_lock lock(plan);
+        const auto                  plan_info     = plan->info;
+        const auto                  plan_stream   = plan->stream;
+        const bool                  info_has_work = plan->info_has_work_buffer;
+
+        const bool borrows = group_info && plan->autoAllocate && !plan->work_area_group
+                             && !plan->workBuffer && plan->workBufferSize > 0;
+        if(borrows)
+        {
+            plan->info = group_info;
+            res        = hipfftSetInfoCallbacks(plan);
+        }
+        if(res == HIPFFT_SUCCESS
+           && rocfft_execution_info_set_stream(plan->info, stream) != rocfft_status_success)
+            res = HIPFFT_EXEC_FAILED;
+
+        // a stream-ordered work buffer is used after it's allocated,
+        // and freed on its own stream after it's used
+        const auto work_stream = plan->workBufferStream;
+        const bool reorder = plan->workBuffer && plan->workBufferAsync && work_stream != stream;
+        if(res == HIPFFT_SUCCESS && reorder
+           && ((!order && hipEventCreateWithFlags(&order, hipEventDisableTiming) != hipSuccess)
+               || hipEventRecord(order, work_stream) != hipSuccess
+               || hipStreamWaitEvent(stream, order, 0) != hipSuccess))
+            res = HIPFFT_EXEC_FAILED;
+        if(res == HIPFFT_SUCCESS)
+        {
+            plan->stream = stream;
+            res          = hipfftExecLocked(
+                plan, subplans[i], idata[i], odata[i], borrows ? &shared_work : nullptr);
+            plan->stream = plan_stream;
+        }
+        if(res == HIPFFT_SUCCESS && reorder
+           && (hipEventRecord(order, stream) != hipSuccess
+               || hipStreamWaitEvent(work_stream, order, 0) != hipSuccess))
+            res = HIPFFT_EXEC_FAILED;
+        if(borrows)
+        {
+            plan->info                 = plan_info;
+            plan->info_has_work_buffer = info_has_work;
+        }
+        else if(plan_stream != stream)
+            rocfft_execution_info_set_stream(plan->info, plan_stream);
+    }
+
+    // the group's info only holds arguments for launches already made
+    if(group_info)
+        rocfft_execution_info_destroy(group_info);
+    if(order)
+        hipEventDestroy(order);
+    if(shared_size > 0)
+        pool.release(shared_work, stream);
+    return res;
 }
@@ -272,6 +272,194 @@ hipfftResult hipfftExtPlanScaleFactor(hipfftHandle plan, double scalefactor)
     return HIPFFT_NOT_IMPLEMENTED;
 }
 
+hipfftResult hipfftExtPlanScaleDynamic(hipfftHandle plan, int count, const double scales[])
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanLazy(hipfftHandle plan, int lazy)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanHints(hipfftHandle plan, int placement_mask, int direction_mask)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanConcurrentBuild(hipfftHandle plan, int concurrent)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanGetBuildMetrics(hipfftHandle plan, hipfftExtPlanBuildMetrics* metrics)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtSetBatch(hipfftHandle plan, long long int batch)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanClone(hipfftHandle src, hipfftHandle* dst)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanWorkBufferMode(hipfftHandle plan, hipfftExtWorkBufferMode mode)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtSetMemoryLimit(hipfftHandle plan, size_t bytes)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanPrefetchManaged(hipfftHandle plan, int prefetch)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanGetPrefetchStats(hipfftHandle plan, hipfftExtPrefetchStats* stats)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanHostStaging(hipfftHandle plan, int depth, long long int chunk)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanOutOfCore(hipfftHandle plan, int enable)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExecGraph(hipfftHandle plan, void* idata, void* odata, int direction)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExecBatch(
+    hipfftHandle plan, void* idata, void* odata, int direction, long long int nbatch)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult
+    hipfftExtExecScaled(hipfftHandle plan, void* idata, void* odata, int direction, double scale)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtSetStreams(hipfftHandle plan, int count, hipStream_t streams[])
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExecGroup(int          count,
+                                hipfftHandle plans[],
+                                void*        idata[],
+                                void*        odata[],
+                                const int    directions[],
+                                hipStream_t  stream)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanTrimWorkBuffer(hipfftHandle plan)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtWorkBufferPoolTrim()
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtWorkBufferPoolGetStats(hipfftExtWorkBufferPoolStats* stats)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPinnedPoolSetLimit(size_t bytes)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPinnedPoolTrim()
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPinnedPoolGetStats(hipfftExtPinnedPoolStats* stats)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtTrimMemory()
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtSetMemoryPressureCallback(hipfftExtMemoryPressureCallback callback,
+                                                void*                           user_data)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtWorkAreaGroupCreate(hipfftExtWorkAreaGroup* group)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtWorkAreaGroupAddPlan(hipfftExtWorkAreaGroup group, hipfftHandle plan)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtWorkAreaGroupRemovePlan(hipfftExtWorkAreaGroup group, hipfftHandle plan)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtWorkAreaGroupGetSize(hipfftExtWorkAreaGroup group, size_t* size)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtWorkAreaGroupDestroy(hipfftExtWorkAreaGroup group)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanCacheSetCapacity(size_t capacity)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanCacheClear()
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanCacheGetStats(hipfftExtPlanCacheStats* stats)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtExportWisdom(const char* path)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtImportWisdom(const char* path)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
 hipfftResult
     hipfftMakePlan1d(hipfftHandle plan, int nx, hipfftType type, int batch, size_t* workSize)
 {
@@ -642,6 +830,51 @@ hipfftResult hipfftXtGetSizeMany(hipfftHandle   plan,
                                                      executiontype));
 }
 
+hipfftResult hipfftExtEstimateFootprint(hipfftHandle        plan,
+                                        int                 rank,
+                                        long long int*      n,
+                                        long long int*      inembed,
+                                        long long int       istride,
+                                        long long int       idist,
+                                        hipDataType         inputtype,
+                                        long long int*      onembed,
+                                        long long int       ostride,
+                                        long long int       odist,
+                                        hipDataType         outputtype,
+                                        long long int       batch,
+                                        hipDataType         executiontype,
+                                        hipfftExtFootprint* footprint)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtMakePlanManyAsync(hipfftHandle   plan,
+                                        int            rank,
+                                        long long int* n,
+                                        long long int* inembed,
+                                        long long int  istride,
+                                        long long int  idist,
+                                        hipDataType    inputtype,
+                                        long long int* onembed,
+                                        long long int  ostride,
+                                        long long int  odist,
+                                        hipDataType    outputtype,
+                                        long long int  batch,
+                                        hipDataType    executiontype)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanWait(hipfftHandle plan)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
+hipfftResult hipfftExtPlanQuery(hipfftHandle plan)
+{
+    return HIPFFT_NOT_IMPLEMENTED;
+}
+
 hipfftResult hipfftXtExec(hipfftHandle plan, void* input, void* output, int direction)
 {
     return cufftResultToHipResult(cufftXtExec(plan, input, output, direction));